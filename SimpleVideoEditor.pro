@@ -1,4 +1,4 @@
-QT       += core gui multimedia multimediawidgets
+QT       += core gui multimedia multimediawidgets network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -13,7 +13,7 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # In order to do so, uncomment the following line.
 # DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-CONFIG += c++11
+CONFIG += c++17
 
 SOURCES += \
         src/main.cpp \
@@ -22,14 +22,76 @@ SOURCES += \
         src/CropDialog.cpp \
         src/ResizeDialog.cpp \
         src/ConvertDialog.cpp \
-        src/convertVideo.cpp
+        src/convertVideo.cpp \
+        src/FFmpegCapabilities.cpp \
+        src/FFmpegLog.cpp \
+        src/LogViewerDialog.cpp \
+        src/AudioPeaks.cpp \
+        src/WaveformWidget.cpp \
+        src/FFmpegArguments.cpp \
+        src/EncodeEstimator.cpp \
+        src/WatchFolderDaemon.cpp \
+        src/MediaProbe.cpp \
+        src/FFmpegPipeline.cpp \
+        src/KeepRangesWidget.cpp \
+        src/MultiCutExporter.cpp \
+        src/ScaleBenchmark.cpp \
+        src/InputPrefetcher.cpp \
+        src/ResumableExport.cpp \
+        src/JoinDialog.cpp \
+        src/PlaybackMetrics.cpp \
+        src/PlaybackMetricsDialog.cpp \
+        src/SpeedDialog.cpp \
+        src/ExportPreview.cpp \
+        src/ImageSequenceExporter.cpp \
+        src/ImageSequenceDialog.cpp \
+        src/SceneAdaptiveEncoder.cpp \
+        src/MessageChannel.cpp \
+        src/EncodeWorker.cpp \
+        src/DistributedEncoder.cpp \
+        src/QualityVerifier.cpp \
+        src/RotateDialog.cpp \
+        src/AudioDialog.cpp \
+        src/PacketAnalyzer.cpp \
+        src/PacketAnalyzerDialog.cpp
 
 HEADERS += \
         src/SimpleVideoEditor.h \
         src/TrimDialog.h \
         src/CropDialog.h \
         src/ResizeDialog.h \
-        src/ConvertDialog.h
+        src/ConvertDialog.h \
+        src/FFmpegCapabilities.h \
+        src/FFmpegLog.h \
+        src/LogViewerDialog.h \
+        src/AudioPeaks.h \
+        src/WaveformWidget.h \
+        src/FFmpegArguments.h \
+        src/EncodeEstimator.h \
+        src/WatchFolderDaemon.h \
+        src/MediaProbe.h \
+        src/FFmpegPipeline.h \
+        src/KeepRangesWidget.h \
+        src/MultiCutExporter.h \
+        src/ScaleBenchmark.h \
+        src/InputPrefetcher.h \
+        src/ResumableExport.h \
+        src/JoinDialog.h \
+        src/PlaybackMetrics.h \
+        src/PlaybackMetricsDialog.h \
+        src/SpeedDialog.h \
+        src/ExportPreview.h \
+        src/ImageSequenceExporter.h \
+        src/ImageSequenceDialog.h \
+        src/SceneAdaptiveEncoder.h \
+        src/MessageChannel.h \
+        src/EncodeWorker.h \
+        src/DistributedEncoder.h \
+        src/QualityVerifier.h \
+        src/RotateDialog.h \
+        src/AudioDialog.h \
+        src/PacketAnalyzer.h \
+        src/PacketAnalyzerDialog.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,212 @@
+#include "AudioDialog.h"
+#include "FFmpegCapabilities.h"
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFileInfo>
+
+AudioDialog::AudioDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent)
+    : QDialog(parent), videoFile(videoFile), info(info)
+{
+    setWindowTitle("Edit Audio");
+
+    QFormLayout *layout = new QFormLayout(this);
+
+    // Operations on the existing track need one to exist
+    operationCombo = new QComboBox(this);
+    operationCombo->addItem("Remove audio", Remove);
+    operationCombo->addItem("Replace from file", Replace);
+    if (info.hasAudio)
+    {
+        operationCombo->addItem("Normalize loudness", Normalize);
+        operationCombo->addItem("Adjust volume", AdjustVolume);
+        operationCombo->addItem("Change codec", ChangeCodec);
+    }
+    layout->addRow("Operation:", operationCombo);
+
+    replacementInput = new QLineEdit(this);
+    browseButton = new QPushButton("Browse...", this);
+    QHBoxLayout *replacementLayout = new QHBoxLayout();
+    replacementLayout->addWidget(replacementInput);
+    replacementLayout->addWidget(browseButton);
+    layout->addRow("Audio File:", replacementLayout);
+
+    shortestCheckbox = new QCheckBox("End with the shorter of video and audio", this);
+    shortestCheckbox->setChecked(true);
+    layout->addRow("", shortestCheckbox);
+
+    loudnessCombo = new QComboBox(this);
+    loudnessCombo->addItem("Streaming (-16 LUFS)", -16.0);
+    loudnessCombo->addItem("Loud streaming (-14 LUFS)", -14.0);
+    loudnessCombo->addItem("Broadcast, EBU R128 (-23 LUFS)", -23.0);
+    layout->addRow("Target Loudness:", loudnessCombo);
+
+    volumeInput = new QDoubleSpinBox(this);
+    volumeInput->setRange(-40.0, 40.0);
+    volumeInput->setDecimals(1);
+    volumeInput->setSingleStep(1.0);
+    volumeInput->setValue(6.0);
+    volumeInput->setSuffix(" dB");
+    layout->addRow("Volume Change:", volumeInput);
+
+    // Each codec's fastest available encoder, as in the Convert dialog,
+    // starting on the one that suits the source
+    codecCombo = new QComboBox(this);
+    QString preferredCodec = defaultCodec(videoFile, info);
+    struct AudioEntry
+    {
+        const char *label;
+        const char *codec;
+    };
+    const AudioEntry audioCodecs[] = {
+        {"AAC", "aac"},
+        {"MP3", "mp3"},
+        {"Opus", "opus"},
+        {"AC-3", "ac3"},
+        {"FLAC", "flac"},
+    };
+    for (const AudioEntry &entry : audioCodecs)
+    {
+        QString encoder = FFmpegCapabilities::instance().bestEncoder(entry.codec);
+        if (encoder.isEmpty())
+            continue;
+        codecCombo->addItem(entry.label, encoder);
+        if (preferredCodec == entry.codec)
+            codecCombo->setCurrentIndex(codecCombo->count() - 1);
+    }
+    layout->addRow("Audio Codec:", codecCombo);
+
+    bitrateInput = new QSpinBox(this);
+    bitrateInput->setRange(32, 640);
+    bitrateInput->setValue(192);
+    bitrateInput->setSingleStep(32);
+    bitrateInput->setSuffix(" kbps");
+    layout->addRow("Audio Bitrate:", bitrateInput);
+
+    summaryLabel = new QLabel(this);
+    summaryLabel->setWordWrap(true);
+    layout->addRow(summaryLabel);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    okButton = buttonBox->button(QDialogButtonBox::Ok);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    connect(operationCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &AudioDialog::updateControls);
+    connect(codecCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &AudioDialog::updateControls);
+    connect(replacementInput, &QLineEdit::textChanged, this, &AudioDialog::updateControls);
+    connect(browseButton, &QPushButton::clicked, this, &AudioDialog::browseReplacement);
+
+    updateControls();
+}
+
+AudioDialog::Settings AudioDialog::getSettings() const
+{
+    Settings settings;
+    settings.operation = Operation(operationCombo->currentData().toInt());
+    settings.replacementFile = replacementInput->text();
+    settings.shortest = shortestCheckbox->isChecked();
+    settings.loudnessTarget = loudnessCombo->currentData().toDouble();
+    settings.volumeDb = volumeInput->value();
+    settings.codec = codecCombo->currentData().toString();
+    settings.bitrate = bitrateInput->value();
+    settings.sampleRate = info.sampleRate;
+    return settings;
+}
+
+QString AudioDialog::defaultCodec(const QString &videoFile, const MediaInfo &info)
+{
+    // The source's own codec is known to fit the container it came in
+    static const QStringList offered = {"aac", "mp3", "opus", "ac3", "flac"};
+    if (offered.contains(info.audioCodec))
+        return info.audioCodec;
+
+    // WebM takes only Opus and Vorbis; Matroska takes anything, Opus is the better default there
+    QString suffix = QFileInfo(videoFile).suffix().toLower();
+    if (suffix == "webm" || suffix == "mkv")
+        return "opus";
+    return "aac";
+}
+
+QStringList AudioDialog::getFFMPEGArguments(const QString &outputFile) const
+{
+    return buildArguments(videoFile, getSettings(), outputFile);
+}
+
+QStringList AudioDialog::buildArguments(const QString &videoFile, const Settings &settings,
+                                        const QString &outputFile)
+{
+    QStringList args;
+    args << "-y"
+         << "-i" << videoFile;
+    if (settings.operation == Replace)
+        args << "-i" << settings.replacementFile;
+
+    // The video is copied packet for packet, so it is never decoded
+    args << "-map" << "0:v"
+         << "-c:v" << "copy";
+
+    if (settings.operation == Remove)
+    {
+        args << "-an" << outputFile;
+        return args;
+    }
+
+    args << "-map" << (settings.operation == Replace ? "1:a:0" : "0:a");
+
+    if (settings.operation == Normalize)
+    {
+        // Single-pass loudnorm; it runs at 192 kHz internally, so the rate is set back explicitly
+        args << "-af" << QString("loudnorm=I=%1:TP=-1.5:LRA=11").arg(settings.loudnessTarget);
+        args << "-ar" << QString::number(settings.sampleRate > 0 ? settings.sampleRate : 48000);
+    }
+    else if (settings.operation == AdjustVolume)
+    {
+        args << "-af" << QString("volume=%1dB").arg(settings.volumeDb);
+    }
+
+    args << "-c:a" << settings.codec;
+    if (!settings.codec.contains("flac"))
+        args << "-b:a" << QString::number(settings.bitrate) + "k";
+
+    if (settings.operation == Replace && settings.shortest)
+        args << "-shortest";
+
+    args << outputFile;
+    return args;
+}
+
+void AudioDialog::updateControls()
+{
+    Operation operation = Operation(operationCombo->currentData().toInt());
+    bool replace = operation == Replace;
+
+    replacementInput->setEnabled(replace);
+    browseButton->setEnabled(replace);
+    shortestCheckbox->setEnabled(replace);
+    loudnessCombo->setEnabled(operation == Normalize);
+    volumeInput->setEnabled(operation == AdjustVolume);
+    codecCombo->setEnabled(operation != Remove);
+    bitrateInput->setEnabled(operation != Remove && !codecCombo->currentData().toString().contains("flac"));
+
+    okButton->setEnabled(!replace || QFileInfo(replacementInput->text()).isFile());
+
+    QString text = "The video stream is copied as-is; only the audio is processed.";
+    if (operation == Normalize)
+        text += "\nLoudness is normalized in a single pass with ffmpeg's loudnorm filter.";
+    summaryLabel->setText(text);
+}
+
+void AudioDialog::browseReplacement()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "Open Audio", "",
+                                                    "Audio Files (*.wav *.mp3 *.m4a *.aac *.flac *.ogg *.opus);;"
+                                                    "Video Files (*.mp4 *.mov *.mkv *.webm);;All Files (*)");
+    if (!fileName.isEmpty())
+        replacementInput->setText(fileName);
+}
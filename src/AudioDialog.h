@@ -0,0 +1,74 @@
+#ifndef AUDIODIALOG_H
+#define AUDIODIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include "MediaProbe.h"
+
+// Audio-only edits: the video stream is always copied, never decoded
+class AudioDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    enum Operation
+    {
+        Remove,
+        Replace,
+        Normalize,
+        AdjustVolume,
+        ChangeCodec
+    };
+
+    struct Settings
+    {
+        Operation operation = ChangeCodec;
+        QString replacementFile; // Replace: audio is taken from its first audio stream
+        bool shortest = true;    // Replace: end with whichever stream is shorter
+        double loudnessTarget = -16; // Normalize: integrated loudness, LUFS
+        double volumeDb = 0;         // AdjustVolume
+        QString codec = "aac";
+        int bitrate = 192; // kbps; ignored by lossless codecs
+        int sampleRate = 0; // Output rate after loudnorm, which resamples internally; 0 keeps the default
+    };
+
+    AudioDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent = nullptr);
+
+    Settings getSettings() const;
+    QStringList getFFMPEGArguments(const QString &outputFile) const;
+
+    static QStringList buildArguments(const QString &videoFile, const Settings &settings,
+                                      const QString &outputFile);
+
+    // Codec the dialog starts on: the source's own when it is offered, else one its container accepts
+    static QString defaultCodec(const QString &videoFile, const MediaInfo &info);
+
+private slots:
+    void updateControls();
+    void browseReplacement();
+
+private:
+    QString videoFile;
+    MediaInfo info;
+
+    QComboBox *operationCombo;
+    QLineEdit *replacementInput;
+    QPushButton *browseButton;
+    QCheckBox *shortestCheckbox;
+    QComboBox *loudnessCombo;
+    QDoubleSpinBox *volumeInput;
+    QComboBox *codecCombo;
+    QSpinBox *bitrateInput;
+    QLabel *summaryLabel;
+    QPushButton *okButton;
+};
+
+#endif // AUDIODIALOG_H
@@ -0,0 +1,317 @@
+#include "AudioPeaks.h"
+#include <QProcess>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+namespace
+{
+    const quint32 cacheMagic = 0x53415650; // "SAVP"
+    const quint32 cacheVersion = 1;
+}
+
+AudioPeaks::AudioPeaks(QObject *parent)
+    : QObject(parent), totalSamples(0), loaded(false), failedLoad(false), decoder(nullptr)
+{
+}
+
+AudioPeaks::~AudioPeaks()
+{
+    clear();
+}
+
+void AudioPeaks::load(const QString &mediaFile)
+{
+    clear();
+    sourceFile = mediaFile;
+
+    if (loadCache())
+    {
+        loaded = true;
+        emit ready();
+        return;
+    }
+
+    levels.resize(1);
+
+    // Audio-only decode straight to mono 16-bit PCM; video is never touched
+    decoder = new QProcess(this);
+    connect(decoder, &QProcess::readyReadStandardOutput, this, &AudioPeaks::readSamples);
+    connect(decoder, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                readSamples();
+
+                // Fold in the final partial block
+                int remaining = pendingBytes.size() / int(sizeof(qint16));
+                if (remaining > 0)
+                {
+                    const qint16 *samples = reinterpret_cast<const qint16 *>(pendingBytes.constData());
+                    qint16 lo = samples[0];
+                    qint16 hi = samples[0];
+                    for (int i = 1; i < remaining; ++i)
+                    {
+                        lo = qMin(lo, samples[i]);
+                        hi = qMax(hi, samples[i]);
+                    }
+                    levels[0].mins.append(lo);
+                    levels[0].maxs.append(hi);
+                    totalSamples += remaining;
+                }
+                pendingBytes.clear();
+
+                QString error = QString::fromUtf8(decoder->readAllStandardError()).trimmed();
+                decoder->deleteLater();
+                decoder = nullptr;
+
+                if (exitCode != 0 || levels[0].mins.isEmpty())
+                {
+                    levels.clear();
+                    failedLoad = true;
+                    emit failed(error.isEmpty() ? "No audio track" : error);
+                    return;
+                }
+
+                buildUpperLevels();
+                loaded = true;
+                saveCache();
+                emit ready();
+            });
+
+    QStringList args;
+    args << "-v" << "error"
+         << "-i" << mediaFile
+         << "-vn" << "-sn" << "-dn"
+         << "-ac" << "1"
+         << "-ar" << QString::number(sampleRate)
+         << "-f" << "s16le" << "-";
+
+    decoder->start("ffmpeg", args);
+}
+
+void AudioPeaks::clear()
+{
+    if (decoder)
+    {
+        decoder->disconnect(this);
+        decoder->kill();
+        decoder->deleteLater();
+        decoder = nullptr;
+    }
+
+    levels.clear();
+    pendingBytes.clear();
+    totalSamples = 0;
+    loaded = false;
+    failedLoad = false;
+}
+
+bool AudioPeaks::isReady() const
+{
+    return loaded;
+}
+
+bool AudioPeaks::hasFailed() const
+{
+    return failedLoad;
+}
+
+qint64 AudioPeaks::durationMs() const
+{
+    return totalSamples * 1000 / sampleRate;
+}
+
+void AudioPeaks::peaksForRange(qint64 startMs, qint64 endMs, int columns,
+                               QVector<qint16> &mins, QVector<qint16> &maxs) const
+{
+    mins.fill(0, qMax(columns, 0));
+    maxs.fill(0, qMax(columns, 0));
+    if (!loaded || levels.isEmpty() || columns <= 0 || endMs <= startMs)
+        return;
+
+    // Pick the coarsest level that still has at least one bucket per column
+    double samplesPerColumn = double(endMs - startMs) * sampleRate / 1000.0 / columns;
+    int level = 0;
+    qint64 blockSize = baseBlockSize;
+    while (level + 1 < levels.size() && blockSize * 2 <= samplesPerColumn)
+    {
+        ++level;
+        blockSize *= 2;
+    }
+
+    const Level &data = levels[level];
+    const qint64 bucketCount = data.mins.size();
+    const qint64 startSample = startMs * sampleRate / 1000;
+
+    for (int column = 0; column < columns; ++column)
+    {
+        qint64 first = (startSample + qint64(column * samplesPerColumn)) / blockSize;
+        qint64 last = (startSample + qint64((column + 1) * samplesPerColumn) + blockSize - 1) / blockSize;
+        last = qMin(qMax(last, first + 1), bucketCount);
+        if (first >= bucketCount)
+            break;
+
+        qint16 lo = data.mins[first];
+        qint16 hi = data.maxs[first];
+        for (qint64 bucket = first + 1; bucket < last; ++bucket)
+        {
+            lo = qMin(lo, data.mins[bucket]);
+            hi = qMax(hi, data.maxs[bucket]);
+        }
+        mins[column] = lo;
+        maxs[column] = hi;
+    }
+}
+
+void AudioPeaks::readSamples()
+{
+    if (!decoder)
+        return;
+
+    // Only a partial block is ever carried over, so memory stays flat during the decode
+    pendingBytes.append(decoder->readAllStandardOutput());
+
+    const int blockBytes = baseBlockSize * int(sizeof(qint16));
+    int blockCount = pendingBytes.size() / blockBytes;
+    if (blockCount == 0)
+        return;
+
+    consumeBlocks(reinterpret_cast<const qint16 *>(pendingBytes.constData()), blockCount);
+    pendingBytes.remove(0, blockCount * blockBytes);
+}
+
+void AudioPeaks::consumeBlocks(const qint16 *samples, int blockCount)
+{
+    Level &base = levels[0];
+    int offset = base.mins.size();
+    base.mins.resize(offset + blockCount);
+    base.maxs.resize(offset + blockCount);
+
+    qint16 *mins = base.mins.data() + offset;
+    qint16 *maxs = base.maxs.data() + offset;
+
+    for (int block = 0; block < blockCount; ++block)
+    {
+        const qint16 *in = samples + block * baseBlockSize;
+
+        // Fixed-length, branch-free reduction: compilers emit packed min/max for this
+        qint16 lo = in[0];
+        qint16 hi = in[0];
+        for (int i = 1; i < baseBlockSize; ++i)
+        {
+            lo = in[i] < lo ? in[i] : lo;
+            hi = in[i] > hi ? in[i] : hi;
+        }
+        mins[block] = lo;
+        maxs[block] = hi;
+    }
+
+    totalSamples += qint64(blockCount) * baseBlockSize;
+}
+
+void AudioPeaks::buildUpperLevels()
+{
+    levels.resize(1);
+
+    while (levels.last().mins.size() > 1)
+    {
+        const Level &below = levels.last();
+        int count = (below.mins.size() + 1) / 2;
+
+        Level above;
+        above.mins.resize(count);
+        above.maxs.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            int left = i * 2;
+            int right = qMin(left + 1, int(below.mins.size()) - 1);
+            above.mins[i] = qMin(below.mins[left], below.mins[right]);
+            above.maxs[i] = qMax(below.maxs[left], below.maxs[right]);
+        }
+        levels.append(above);
+    }
+}
+
+QString AudioPeaks::cacheFileFor(const QString &mediaFile, bool nextToSource) const
+{
+    if (nextToSource)
+        return mediaFile + ".peaks";
+
+    QByteArray key = QCryptographicHash::hash(QFileInfo(mediaFile).absoluteFilePath().toUtf8(),
+                                              QCryptographicHash::Sha1)
+                         .toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/peaks/" + key + ".peaks";
+}
+
+bool AudioPeaks::loadCache()
+{
+    QFileInfo sourceInfo(sourceFile);
+
+    for (bool nextToSource : {true, false})
+    {
+        QFile file(cacheFileFor(sourceFile, nextToSource));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_6_0);
+
+        quint32 magic, version, rate, blockSize;
+        qint64 sourceSize, sourceModified, samples;
+        in >> magic >> version >> sourceSize >> sourceModified >> rate >> blockSize >> samples;
+
+        // Stale if the source changed or the layout differs from this build's
+        if (magic != cacheMagic || version != cacheVersion ||
+            sourceSize != sourceInfo.size() ||
+            sourceModified != sourceInfo.lastModified().toMSecsSinceEpoch() ||
+            rate != quint32(sampleRate) || blockSize != quint32(baseBlockSize))
+            continue;
+
+        QVector<Level> cached;
+        quint32 levelCount;
+        in >> levelCount;
+        for (quint32 i = 0; i < levelCount && in.status() == QDataStream::Ok; ++i)
+        {
+            Level level;
+            in >> level.mins >> level.maxs;
+            cached.append(level);
+        }
+
+        if (in.status() != QDataStream::Ok || cached.isEmpty())
+            continue;
+
+        levels = cached;
+        totalSamples = samples;
+        return true;
+    }
+
+    return false;
+}
+
+void AudioPeaks::saveCache() const
+{
+    QFileInfo sourceInfo(sourceFile);
+
+    for (bool nextToSource : {true, false})
+    {
+        QString path = cacheFileFor(sourceFile, nextToSource);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            continue;
+
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << cacheMagic << cacheVersion
+            << qint64(sourceInfo.size()) << qint64(sourceInfo.lastModified().toMSecsSinceEpoch())
+            << quint32(sampleRate) << quint32(baseBlockSize) << totalSamples
+            << quint32(levels.size());
+        for (const Level &level : levels)
+            out << level.mins << level.maxs;
+        return;
+    }
+}
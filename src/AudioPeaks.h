@@ -0,0 +1,67 @@
+#ifndef AUDIOPEAKS_H
+#define AUDIOPEAKS_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+class QProcess;
+
+// Multi-resolution min/max peaks of a file's audio track. Level 0 holds one
+// min/max pair per baseBlockSize samples and each level above halves the
+// resolution, so any zoom level is drawn from at most a couple of buckets per
+// pixel column. Peaks are cached next to the source (or in the cache directory
+// if that is read-only) so reopening a file is instant.
+class AudioPeaks : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioPeaks(QObject *parent = nullptr);
+    ~AudioPeaks();
+
+    void load(const QString &mediaFile);
+    void clear();
+
+    bool isReady() const;
+    bool hasFailed() const; // No audio track, or ffmpeg could not decode it
+    qint64 durationMs() const;
+
+    // Fills one min/max pair per column covering [startMs, endMs)
+    void peaksForRange(qint64 startMs, qint64 endMs, int columns,
+                       QVector<qint16> &mins, QVector<qint16> &maxs) const;
+
+signals:
+    void ready();
+    void failed(const QString &error);
+
+private:
+    struct Level
+    {
+        QVector<qint16> mins;
+        QVector<qint16> maxs;
+    };
+
+    static const int sampleRate = 8000;   // Plenty for an amplitude envelope
+    static const int baseBlockSize = 64;  // Samples per level-0 bucket (8 ms)
+
+    void readSamples();
+    void consumeBlocks(const qint16 *samples, int blockCount);
+    void buildUpperLevels();
+
+    QString cacheFileFor(const QString &mediaFile, bool nextToSource) const;
+    bool loadCache();
+    void saveCache() const;
+
+    QString sourceFile;
+    QVector<Level> levels;
+    qint64 totalSamples;
+    bool loaded;
+    bool failedLoad;
+
+    QProcess *decoder;
+    QByteArray pendingBytes; // Tail of the last read that did not fill a whole block
+};
+
+#endif // AUDIOPEAKS_H
@@ -1,13 +1,66 @@
 #include "ConvertDialog.h"
+#include "FFmpegCapabilities.h"
+#include "EncodeEstimator.h"
+#include "ExportPreview.h"
+#include "SceneAdaptiveEncoder.h"
 #include <QFormLayout>
 #include <QDialogButtonBox>
 #include <QVBoxLayout>
 #include <QGroupBox>
 #include <QLabel>
 #include <QFileInfo>
+#include <QLocale>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QJsonDocument>
+#include <QTime>
 
-ConvertDialog::ConvertDialog(const QString &videoFile, QWidget *parent)
-    : QDialog(parent), videoFile(videoFile)
+ConvertDialog::Settings::Settings()
+    : format("mp4"), videoBitrate(2000), segmentLength(6),
+      decimate(false), staticContent(false), sceneAdaptive(false), targetSsim(0.97),
+      convertAudio(true), audioCodec("aac"), audioBitrate(128)
+{
+}
+
+QJsonObject ConvertDialog::Settings::toJson() const
+{
+    QJsonObject json;
+    json["format"] = format;
+    json["videoEncoder"] = videoEncoder;
+    json["videoBitrate"] = videoBitrate;
+    json["segmentLength"] = segmentLength;
+    json["decimate"] = decimate;
+    json["staticContent"] = staticContent;
+    json["sceneAdaptive"] = sceneAdaptive;
+    json["targetSsim"] = targetSsim;
+    json["audio"] = convertAudio;
+    json["audioCodec"] = audioCodec;
+    json["audioBitrate"] = audioBitrate;
+    return json;
+}
+
+ConvertDialog::Settings ConvertDialog::Settings::fromJson(const QJsonObject &json)
+{
+    // Missing keys keep their defaults so hand-written presets can stay short
+    Settings settings;
+    settings.format = json["format"].toString(settings.format);
+    settings.videoEncoder = json["videoEncoder"].toString();
+    settings.videoBitrate = json["videoBitrate"].toInt(settings.videoBitrate);
+    settings.segmentLength = json["segmentLength"].toInt(settings.segmentLength);
+    settings.decimate = json["decimate"].toBool(settings.decimate);
+    settings.staticContent = json["staticContent"].toBool(settings.staticContent);
+    settings.sceneAdaptive = json["sceneAdaptive"].toBool(settings.sceneAdaptive);
+    settings.targetSsim = json["targetSsim"].toDouble(settings.targetSsim);
+    settings.convertAudio = json["audio"].toBool(settings.convertAudio);
+    settings.audioCodec = json["audioCodec"].toString(settings.audioCodec);
+    settings.audioBitrate = json["audioBitrate"].toInt(settings.audioBitrate);
+    return settings;
+}
+
+ConvertDialog::ConvertDialog(const QString &videoFile, qint64 duration, QWidget *parent)
+    : QDialog(parent), videoFile(videoFile), durationSeconds(duration / 1000.0),
+      estimator(new EncodeEstimator(this))
 {
     setWindowTitle("Convert Video Format");
     setMinimumWidth(400);
@@ -24,15 +77,13 @@ ConvertDialog::ConvertDialog(const QString &videoFile, QWidget *parent)
     QGroupBox *formatGroupBox = new QGroupBox("Format Settings", this);
     QFormLayout *formatLayout = new QFormLayout(formatGroupBox);
     
-    // Format selection
+    // Format selection (filled in by applyCapabilities)
     formatCombo = new QComboBox(this);
-    formatCombo->addItem("MP4 (H.264)", "mp4");
-    formatCombo->addItem("WebM (VP9)", "webm");
-    formatCombo->addItem("MKV (H.264)", "mkv");
-    formatCombo->addItem("AVI (MJPEG)", "avi");
-    formatCombo->addItem("MOV (H.264)", "mov");
-    formatCombo->addItem("GIF (animated)", "gif");
     formatLayout->addRow("Target Format:", formatCombo);
+
+    // Video encoder, fastest available implementation first
+    videoEncoderCombo = new QComboBox(this);
+    formatLayout->addRow("Video Encoder:", videoEncoderCombo);
     
     // Video bitrate
     videoBitrateInput = new QSpinBox(this);
@@ -40,6 +91,35 @@ ConvertDialog::ConvertDialog(const QString &videoFile, QWidget *parent)
     videoBitrateInput->setValue(2000);
     videoBitrateInput->setSuffix(" kbps");
     formatLayout->addRow("Video Bitrate:", videoBitrateInput);
+
+    // Segment length for HLS/DASH; keyframes are forced on every boundary
+    segmentLengthInput = new QSpinBox(this);
+    segmentLengthInput->setRange(1, 60);
+    segmentLengthInput->setValue(6);
+    segmentLengthInput->setSuffix(" sec");
+    formatLayout->addRow("Segment Length:", segmentLengthInput);
+
+    // Screen recordings: most frames repeat the previous one
+    decimateCheckbox = new QCheckBox("Drop duplicate frames (variable frame rate)", this);
+    formatLayout->addRow("", decimateCheckbox);
+
+    staticContentCheckbox = new QCheckBox("Tune for static content (screen recordings)", this);
+    staticContentCheckbox->setToolTip("Constant quality with the bitrate as a ceiling, so still stretches cost almost nothing");
+    formatLayout->addRow("", staticContentCheckbox);
+
+    // Busy scenes get more bits and quiet ones fewer, for the same quality throughout
+    sceneAdaptiveCheckbox = new QCheckBox("Adapt quality per scene", this);
+    sceneAdaptiveCheckbox->setToolTip("Detects scenes, picks a CRF for each from quick low-resolution test encodes, "
+                                      "and encodes the scenes in parallel. The bitrate becomes a ceiling.");
+    formatLayout->addRow("", sceneAdaptiveCheckbox);
+
+    qualityTargetCombo = new QComboBox(this);
+    qualityTargetCombo->addItem("High (SSIM 0.98)", 0.98);
+    qualityTargetCombo->addItem("Balanced (SSIM 0.97)", 0.97);
+    qualityTargetCombo->addItem("Compact (SSIM 0.95)", 0.95);
+    qualityTargetCombo->setCurrentIndex(1);
+    qualityTargetCombo->setEnabled(false);
+    formatLayout->addRow("Quality Target:", qualityTargetCombo);
     
     mainLayout->addWidget(formatGroupBox);
     
@@ -52,12 +132,8 @@ ConvertDialog::ConvertDialog(const QString &videoFile, QWidget *parent)
     convertAudioCheckbox->setChecked(true);
     audioLayout->addRow("", convertAudioCheckbox);
     
-    // Audio codec
+    // Audio codec (filled in by applyCapabilities)
     audioCodecCombo = new QComboBox(this);
-    audioCodecCombo->addItem("AAC", "aac");
-    audioCodecCombo->addItem("MP3", "libmp3lame");
-    audioCodecCombo->addItem("Opus", "libopus");
-    audioCodecCombo->addItem("FLAC", "flac");
     audioLayout->addRow("Audio Codec:", audioCodecCombo);
     
     // Audio bitrate
@@ -68,20 +144,74 @@ ConvertDialog::ConvertDialog(const QString &videoFile, QWidget *parent)
     audioLayout->addRow("Audio Bitrate:", audioBitrateInput);
     
     mainLayout->addWidget(audioGroupBox);
+
+    // Size/time estimate from a few sample encodes
+    QGroupBox *estimateGroupBox = new QGroupBox("Size Estimate", this);
+    QFormLayout *estimateLayout = new QFormLayout(estimateGroupBox);
+
+    targetSizeCheckbox = new QCheckBox("Aim for a file size", this);
+    estimateLayout->addRow("", targetSizeCheckbox);
+
+    targetSizeInput = new QSpinBox(this);
+    targetSizeInput->setRange(1, 100000);
+    targetSizeInput->setValue(100);
+    targetSizeInput->setSuffix(" MB");
+    targetSizeInput->setEnabled(false);
+    estimateLayout->addRow("Target Size:", targetSizeInput);
+
+    estimateButton = new QPushButton("Estimate Size and Time", this);
+    estimateLabel = new QLabel(this);
+    estimateLabel->setWordWrap(true);
+    estimateLayout->addRow(estimateButton);
+    estimateLayout->addRow(estimateLabel);
+
+    mainLayout->addWidget(estimateGroupBox);
+
+    connect(estimateButton, &QPushButton::clicked, this, &ConvertDialog::runEstimate);
+    connect(estimator, &EncodeEstimator::estimated, this, &ConvertDialog::showEstimate);
+    connect(estimator, &EncodeEstimator::failed, this, [this](const QString &error)
+            {
+        estimateButton->setEnabled(true);
+        estimateLabel->setText("Estimate failed: " + error); });
+    connect(targetSizeCheckbox, &QCheckBox::toggled, this, &ConvertDialog::updateTargetBitrate);
+    connect(targetSizeInput, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ConvertDialog::updateTargetBitrate);
+    connect(audioBitrateInput, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ConvertDialog::updateTargetBitrate);
     
     // Connect signals
     connect(convertAudioCheckbox, &QCheckBox::toggled,
             this, &ConvertDialog::updateAudioOptions);
     connect(formatCombo, &QComboBox::currentTextChanged,
             this, &ConvertDialog::updateFormatSettings);
+    connect(sceneAdaptiveCheckbox, &QCheckBox::toggled, qualityTargetCombo, &QComboBox::setEnabled);
+    connect(videoEncoderCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ConvertDialog::updateSceneAdaptiveAvailability);
+    connect(staticContentCheckbox, &QCheckBox::toggled, this, [this](bool checked)
+            {
+        if (checked && decimateCheckbox->isEnabled())
+            decimateCheckbox->setChecked(true); });
     
     // Add buttons
     QDialogButtonBox *buttonBox = new QDialogButtonBox(
         QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+
+    // Presets feed the watch-folder mode (--watch) with these exact settings
+    savePresetButton = buttonBox->addButton("Save Preset...", QDialogButtonBox::ActionRole);
+    connect(savePresetButton, &QPushButton::clicked, this, &ConvertDialog::savePreset);
+
+    // Encodes a few seconds at the playhead with these settings and plays them in the main window
+    exportPreviewButton = new ExportPreviewButton(this);
+    buttonBox->addButton(exportPreviewButton, QDialogButtonBox::ActionRole);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
     mainLayout->addWidget(buttonBox);
     
+    // Only offer what the installed ffmpeg can actually produce
+    applyCapabilities();
+    connect(&FFmpegCapabilities::instance(), &FFmpegCapabilities::ready,
+            this, &ConvertDialog::applyCapabilities);
+
     // Initialize UI
     updateAudioOptions(convertAudioCheckbox->isChecked());
     updateFormatSettings(formatCombo->currentText());
@@ -92,6 +222,36 @@ QString ConvertDialog::getOutputFormat() const
     return formatCombo->currentData().toString();
 }
 
+QString ConvertDialog::getOutputExtension() const
+{
+    return extensionForFormat(getOutputFormat());
+}
+
+bool ConvertDialog::isStreamingFormat() const
+{
+    return isStreamingFormat(getOutputFormat());
+}
+
+QString ConvertDialog::extensionForFormat(const QString &format)
+{
+    // Streaming formats are saved as their top-level playlist/manifest
+    if (format.startsWith("hls"))
+        return "m3u8";
+    if (format == "dash")
+        return "mpd";
+    return format;
+}
+
+bool ConvertDialog::isStreamingFormat(const QString &format)
+{
+    return format.startsWith("hls") || format == "dash";
+}
+
+int ConvertDialog::getSegmentLength() const
+{
+    return segmentLengthInput->value();
+}
+
 int ConvertDialog::getVideoBitrate() const
 {
     return videoBitrateInput->value();
@@ -112,67 +272,257 @@ QString ConvertDialog::getAudioCodec() const
     return audioCodecCombo->currentData().toString();
 }
 
+QString ConvertDialog::getVideoEncoder() const
+{
+    return videoEncoderCombo->currentData().toString();
+}
+
+bool ConvertDialog::getDecimate() const
+{
+    return decimateCheckbox->isEnabled() && decimateCheckbox->isChecked();
+}
+
+bool ConvertDialog::getStaticContent() const
+{
+    return staticContentCheckbox->isChecked();
+}
+
+bool ConvertDialog::getSceneAdaptive() const
+{
+    return sceneAdaptiveCheckbox->isEnabled() && sceneAdaptiveCheckbox->isChecked();
+}
+
+double ConvertDialog::getTargetSsim() const
+{
+    return qualityTargetCombo->currentData().toDouble();
+}
+
 QStringList ConvertDialog::getFFMPEGArguments(const QString &outputFile) const
 {
+    return buildArguments(videoFile, getSettings(), outputFile);
+}
+
+ConvertDialog::Settings ConvertDialog::getSettings() const
+{
+    Settings settings;
+    settings.format = getOutputFormat();
+    settings.videoEncoder = getVideoEncoder();
+    settings.videoBitrate = getVideoBitrate();
+    settings.segmentLength = getSegmentLength();
+    settings.decimate = getDecimate();
+    settings.staticContent = getStaticContent();
+    settings.sceneAdaptive = getSceneAdaptive();
+    settings.targetSsim = getTargetSsim();
+    settings.convertAudio = getConvertAudio();
+    settings.audioCodec = getAudioCodec();
+    settings.audioBitrate = getAudioBitrate();
+    return settings;
+}
+
+QStringList ConvertDialog::buildArguments(const QString &videoFile, const Settings &settings,
+                                          const QString &outputFile)
+{
+    QString videoEncoder = settings.videoEncoder.isEmpty()
+                               ? FFmpegCapabilities::instance().bestEncoder(videoCodecForFormat(settings.format))
+                               : settings.videoEncoder;
+
     QStringList args;
     
     args << "-y"                      // Overwrite output files without asking
          << "-i" << videoFile;        // Input file
     
     // Handle audio settings
-    if (!getConvertAudio())
+    if (!settings.convertAudio)
     {
         args << "-an";                // No audio
     }
     else
     {
-        args << "-c:a" << getAudioCodec()  // Audio codec
-             << "-b:a" << QString::number(getAudioBitrate()) + "k";  // Audio bitrate
+        args << "-c:a" << settings.audioCodec  // Audio codec
+             << "-b:a" << QString::number(settings.audioBitrate) + "k";  // Audio bitrate
     }
     
     // Format-specific settings
-    QString format = getOutputFormat();
+    const QString &format = settings.format;
     if (format == "webm")
     {
-        args << "-c:v" << "libvpx-vp9"
-             << "-b:v" << QString::number(getVideoBitrate()) + "k";
+        args << "-c:v" << videoEncoder
+             << rateControlArguments(videoEncoder, settings);
     }
     else if (format == "gif")
     {
         // For GIF, we need a specific filter chain
-        args << "-vf" << "fps=10,scale=320:-1:flags=lanczos,split[s0][s1];[s0]palettegen[p];[s1][p]paletteuse"
+        QString decimation = settings.decimate ? "mpdecimate," : "";
+        args << "-vf" << "fps=10," + decimation + "scale=320:-1:flags=lanczos,split[s0][s1];[s0]palettegen[p];[s1][p]paletteuse"
              << "-loop" << "0"; // Loop forever
     }
     else if (format == "mp4" || format == "mov")
     {
-        args << "-c:v" << "libx264"
-             << "-b:v" << QString::number(getVideoBitrate()) + "k";
+        args << "-c:v" << videoEncoder
+             << rateControlArguments(videoEncoder, settings);
     }
     else if (format == "mkv")
     {
-        args << "-c:v" << "libx264"
-             << "-b:v" << QString::number(getVideoBitrate()) + "k";
+        args << "-c:v" << videoEncoder
+             << rateControlArguments(videoEncoder, settings);
     }
     else if (format == "avi")
     {
-        args << "-c:v" << "mjpeg"
-             << "-b:v" << QString::number(getVideoBitrate()) + "k";
+        args << "-c:v" << videoEncoder
+             << rateControlArguments(videoEncoder, settings);
+    }
+    else if (isStreamingFormat(format))
+    {
+        // Segments and playlists are written during the encode, no separate packaging pass
+        QFileInfo outputInfo(outputFile);
+        QString segmentBase = outputInfo.path() + "/" + outputInfo.completeBaseName();
+        QString segmentLength = QString::number(settings.segmentLength);
+
+        args << "-c:v" << videoEncoder
+             << rateControlArguments(videoEncoder, settings)
+             << "-force_key_frames" << "expr:gte(t,n_forced*" + segmentLength + ")";
+
+        if (format == "dash")
+        {
+            args << "-f" << "dash"
+                 << "-seg_duration" << segmentLength
+                 << "-use_template" << "1"
+                 << "-use_timeline" << "1"
+                 << "-init_seg_name" << outputInfo.completeBaseName() + "_init_$RepresentationID$.m4s"
+                 << "-media_seg_name" << outputInfo.completeBaseName() + "_$RepresentationID$_$Number%05d$.m4s";
+        }
+        else
+        {
+            bool fmp4 = format == "hls-fmp4";
+            args << "-f" << "hls"
+                 << "-hls_time" << segmentLength
+                 << "-hls_playlist_type" << "vod"
+                 << "-hls_segment_type" << (fmp4 ? "fmp4" : "mpegts")
+                 << "-hls_segment_filename" << segmentBase + (fmp4 ? "_%05d.m4s" : "_%05d.ts");
+            if (fmp4)
+                args << "-hls_fmp4_init_filename" << outputInfo.completeBaseName() + "_init.mp4";
+        }
     }
     
+    // Surviving frames keep their original timestamps; AVI can't store them
+    if (settings.decimate && format != "avi")
+    {
+        if (format != "gif")
+            args << "-vf" << "mpdecimate";
+        // -fps_mode replaced -vsync in ffmpeg 5.1; older builds only know the latter
+        args << (FFmpegCapabilities::instance().hasOption("fps_mode") ? "-fps_mode" : "-vsync") << "vfr";
+    }
+
     // Add output file
     args << outputFile;
     
     return args;
 }
 
+QStringList ConvertDialog::rateControlArguments(const QString &videoEncoder, const Settings &settings)
+{
+    QString bitrate = QString::number(settings.videoBitrate) + "k";
+    if (!settings.staticContent && !settings.sceneAdaptive)
+        return QStringList() << "-b:v" << bitrate;
+
+    // Constant quality spends next to nothing on still stretches; the bitrate caps busy ones.
+    // Scene-adaptive encodes replace the CRF per scene
+    QString buffer = QString::number(settings.videoBitrate * 2) + "k";
+    if (videoEncoder == "libx264")
+    {
+        QStringList args;
+        args << "-crf" << "23" << "-maxrate" << bitrate << "-bufsize" << buffer;
+        if (settings.staticContent)
+            args << "-tune" << "stillimage"; // Sharper text, less deblocking
+        return args;
+    }
+    if (videoEncoder == "libx265")
+        return QStringList() << "-crf" << "26" << "-maxrate" << bitrate << "-bufsize" << buffer;
+    if (videoEncoder == "libvpx-vp9")
+    {
+        QStringList args;
+        args << "-crf" << "32" << "-b:v" << bitrate; // Constrained quality
+        if (settings.staticContent)
+            args << "-tune-content" << "screen";
+        return args;
+    }
+
+    // Hardware encoders have no portable quality mode; decimation still applies
+    return QStringList() << "-b:v" << bitrate;
+}
+
 void ConvertDialog::updateAudioOptions(bool enabled)
 {
     audioCodecCombo->setEnabled(enabled);
     audioBitrateInput->setEnabled(enabled);
+    updateTargetBitrate();
+}
+
+void ConvertDialog::runEstimate()
+{
+    estimateButton->setEnabled(false);
+    estimateLabel->setText("Encoding samples...");
+
+    // Samples go through exactly the arguments the real export would use
+    estimator->start(durationSeconds, getOutputExtension(), [this](const QString &outputFile)
+                     { return getFFMPEGArguments(outputFile); });
+}
+
+void ConvertDialog::showEstimate(qint64 estimatedBytes, double estimatedSeconds, double measuredKbps)
+{
+    estimateButton->setEnabled(true);
+
+    QString text = QString("Estimated size: %1\nEstimated encode time: %2")
+                       .arg(QLocale().formattedDataSize(estimatedBytes))
+                       .arg(QTime(0, 0).addSecs(qRound(estimatedSeconds)).toString("hh:mm:ss"));
+
+    // Encoders rarely hit a requested bitrate exactly, so correct by what the samples produced
+    if (targetSizeCheckbox->isChecked() && measuredKbps > 0)
+    {
+        double audioKbps = getConvertAudio() ? getAudioBitrate() : 0;
+        double measuredVideoKbps = qMax(1.0, measuredKbps - audioKbps);
+        double targetVideoKbps = targetSizeInput->value() * 8.0 * 1024 * 1024 / 1000.0 / durationSeconds - audioKbps;
+        int corrected = qRound(getVideoBitrate() * targetVideoKbps / measuredVideoKbps);
+
+        if (qAbs(corrected - getVideoBitrate()) > getVideoBitrate() / 50)
+        {
+            videoBitrateInput->setValue(corrected);
+            text += QString("\nBitrate corrected to %1 kbps to meet the target; estimate again to confirm.")
+                        .arg(videoBitrateInput->value());
+        }
+    }
+
+    estimateLabel->setText(text);
+}
+
+void ConvertDialog::updateTargetBitrate()
+{
+    bool targeting = targetSizeCheckbox->isChecked();
+    targetSizeInput->setEnabled(targeting);
+    videoBitrateInput->setEnabled(!targeting);
+
+    if (!targeting || durationSeconds <= 0)
+        return;
+
+    // Total bits for the target size spread over the duration, minus what audio takes
+    double totalKbps = targetSizeInput->value() * 8.0 * 1024 * 1024 / 1000.0 / durationSeconds;
+    double audioKbps = getConvertAudio() ? getAudioBitrate() : 0;
+    int videoKbps = qRound(totalKbps - audioKbps);
+
+    videoBitrateInput->setValue(videoKbps);
+    if (videoKbps < videoBitrateInput->minimum())
+        estimateLabel->setText("Target size is below the minimum video bitrate for this duration.");
 }
 
 void ConvertDialog::updateFormatSettings(const QString &format)
 {
+    updateVideoEncoders();
+    segmentLengthInput->setEnabled(isStreamingFormat());
+    exportPreviewButton->setAvailable(!isStreamingFormat()); // Playlists and segments don't play back as one file
+    exportPreviewButton->setExtension(getOutputExtension());
+    decimateCheckbox->setEnabled(getOutputFormat() != "avi");
+    updateSceneAdaptiveAvailability();
+
     // Adjust recommended settings based on selected format
     if (format.contains("WebM"))
     {
@@ -189,7 +539,8 @@ void ConvertDialog::updateFormatSettings(const QString &format)
             convertAudioCheckbox->setEnabled(true);
         }
     }
-    else if (format.contains("MP4") || format.contains("MOV"))
+    else if (format.contains("MP4") || format.contains("MOV") ||
+             format.contains("HLS") || format.contains("DASH"))
     {
         audioCodecCombo->setCurrentText("AAC");
         convertAudioCheckbox->setEnabled(true);
@@ -200,4 +551,145 @@ void ConvertDialog::updateFormatSettings(const QString &format)
         audioCodecCombo->setCurrentText("FLAC");
         convertAudioCheckbox->setEnabled(true);
     }
-}
\ No newline at end of file
+}
+
+QString ConvertDialog::videoCodecForFormat(const QString &format)
+{
+    if (format == "webm")
+        return "vp9";
+    if (format == "avi")
+        return "mjpeg";
+    if (format == "gif")
+        return "gif";
+    return "h264";
+}
+
+QString ConvertDialog::muxerForFormat(const QString &format)
+{
+    if (format == "mkv")
+        return "matroska";
+    if (format.startsWith("hls"))
+        return "hls";
+    return format;
+}
+
+void ConvertDialog::applyCapabilities()
+{
+    const FFmpegCapabilities &capabilities = FFmpegCapabilities::instance();
+
+    // Rebuild the format list, keeping the current choice where possible
+    QString currentFormat = formatCombo->currentData().toString();
+    formatCombo->blockSignals(true);
+    formatCombo->clear();
+
+    struct FormatEntry
+    {
+        const char *label;
+        const char *format;
+    };
+    const FormatEntry formats[] = {
+        {"MP4 (H.264)", "mp4"},
+        {"WebM (VP9)", "webm"},
+        {"MKV (H.264)", "mkv"},
+        {"AVI (MJPEG)", "avi"},
+        {"MOV (H.264)", "mov"},
+        {"GIF (animated)", "gif"},
+        {"HLS (fMP4 segments)", "hls-fmp4"},
+        {"HLS (TS segments)", "hls-ts"},
+        {"DASH (fMP4 segments)", "dash"},
+    };
+    for (const FormatEntry &entry : formats)
+    {
+        QString format = entry.format;
+        if (!capabilities.hasMuxer(muxerForFormat(format)) ||
+            capabilities.bestEncoder(videoCodecForFormat(format)).isEmpty())
+            continue;
+        if (format == "gif" && !capabilities.hasFilter("palettegen"))
+            continue;
+        formatCombo->addItem(entry.label, format);
+    }
+
+    int formatIndex = formatCombo->findData(currentFormat);
+    formatCombo->setCurrentIndex(formatIndex >= 0 ? formatIndex : 0);
+    formatCombo->blockSignals(false);
+
+    // Map each audio codec to its fastest available encoder
+    QString currentAudio = audioCodecCombo->currentText();
+    audioCodecCombo->clear();
+
+    struct AudioEntry
+    {
+        const char *label;
+        const char *codec;
+    };
+    const AudioEntry audioCodecs[] = {
+        {"AAC", "aac"},
+        {"MP3", "mp3"},
+        {"Opus", "opus"},
+        {"FLAC", "flac"},
+    };
+    for (const AudioEntry &entry : audioCodecs)
+    {
+        QString encoder = capabilities.bestEncoder(entry.codec);
+        if (!encoder.isEmpty())
+            audioCodecCombo->addItem(entry.label, encoder);
+    }
+
+    int audioIndex = audioCodecCombo->findText(currentAudio);
+    if (audioIndex >= 0)
+        audioCodecCombo->setCurrentIndex(audioIndex);
+
+    updateVideoEncoders();
+}
+
+void ConvertDialog::updateVideoEncoders()
+{
+    QString codec = videoCodecForFormat(getOutputFormat());
+    QStringList encoders = FFmpegCapabilities::instance().encodersFor(codec);
+
+    videoEncoderCombo->clear();
+    for (const QString &encoder : encoders)
+        videoEncoderCombo->addItem(encoder, encoder);
+
+    // GIF has no meaningful encoder choice
+    videoEncoderCombo->setEnabled(encoders.size() > 1);
+}
+
+void ConvertDialog::savePreset()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Preset", "", "Presets (*.json)");
+    if (fileName.isEmpty())
+        return;
+
+    // The encoder is left to the machine that runs the preset
+    Settings settings = getSettings();
+    settings.videoEncoder.clear();
+
+    QJsonObject preset;
+    preset["convert"] = settings.toJson();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QMessageBox::warning(this, "Warning", "Could not write preset: " + file.errorString());
+        return;
+    }
+    file.write(QJsonDocument(preset).toJson());
+}
+
+void ConvertDialog::setExportPreview(ExportPreview *preview)
+{
+    exportPreviewButton->setPreview(preview, [this](const QString &outputFile)
+                                    { return getFFMPEGArguments(outputFile); });
+}
+
+void ConvertDialog::updateSceneAdaptiveAvailability()
+{
+    // Needs a CRF encoder and a single output file the scenes can be joined into
+    QString format = getOutputFormat();
+    bool joinable = format == "mp4" || format == "mov" || format == "mkv" || format == "webm";
+    bool available = joinable && SceneAdaptiveEncoder::isSupported(getVideoEncoder());
+
+    sceneAdaptiveCheckbox->setEnabled(available);
+    qualityTargetCombo->setEnabled(available && sceneAdaptiveCheckbox->isChecked());
+}
@@ -5,35 +5,105 @@
 #include <QComboBox>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
 #include <QString>
 #include <QStringList>
+#include <QJsonObject>
+
+class EncodeEstimator;
+class ExportPreview;
+class ExportPreviewButton;
 
 class ConvertDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    ConvertDialog(const QString &videoFile, QWidget *parent = nullptr);
+    // Everything the conversion depends on, independent of the widgets
+    struct Settings
+    {
+        QString format;
+        QString videoEncoder; // Empty picks the fastest available encoder
+        int videoBitrate;
+        int segmentLength;
+        bool decimate;      // Drop near-duplicate frames, variable frame rate output
+        bool staticContent; // Constant quality capped at the bitrate, tuned for screen content
+        bool sceneAdaptive; // Per-scene CRF toward targetSsim, capped at the bitrate
+        double targetSsim;
+        bool convertAudio;
+        QString audioCodec;
+        int audioBitrate;
+
+        Settings();
+        QJsonObject toJson() const;
+        static Settings fromJson(const QJsonObject &json);
+    };
+
+    ConvertDialog(const QString &videoFile, qint64 duration, QWidget *parent = nullptr);
 
     QString getOutputFormat() const;
+    QString getOutputExtension() const;
+    bool isStreamingFormat() const;
+    int getSegmentLength() const;
     int getVideoBitrate() const;
     int getAudioBitrate() const;
     bool getConvertAudio() const;
     QString getAudioCodec() const;
+    QString getVideoEncoder() const;
+    bool getDecimate() const;
+    bool getStaticContent() const;
+    bool getSceneAdaptive() const;
+    double getTargetSsim() const;
     QStringList getFFMPEGArguments(const QString &outputFile) const;
 
+    Settings getSettings() const;
+    static QStringList buildArguments(const QString &videoFile, const Settings &settings,
+                                      const QString &outputFile);
+    static QString extensionForFormat(const QString &format);
+    static bool isStreamingFormat(const QString &format);
+
+    // Shows the Preview Result button, which encodes through this preview
+    void setExportPreview(ExportPreview *preview);
+
 private slots:
     void updateAudioOptions(bool enabled);
     void updateFormatSettings(const QString &format);
+    void applyCapabilities();
+    void runEstimate();
+    void showEstimate(qint64 estimatedBytes, double estimatedSeconds, double measuredKbps);
+    void updateTargetBitrate();
+    void savePreset();
+    void updateSceneAdaptiveAvailability();
 
 private:
+    static QString videoCodecForFormat(const QString &format);
+    static QString muxerForFormat(const QString &format);
+    static QStringList rateControlArguments(const QString &videoEncoder, const Settings &settings);
+    void updateVideoEncoders();
+
     QString videoFile;
+    double durationSeconds;
 
     QComboBox *formatCombo;
+    QComboBox *videoEncoderCombo;
     QSpinBox *videoBitrateInput;
+    QSpinBox *segmentLengthInput;
+    QCheckBox *decimateCheckbox;
+    QCheckBox *staticContentCheckbox;
+    QCheckBox *sceneAdaptiveCheckbox;
+    QComboBox *qualityTargetCombo;
     QCheckBox *convertAudioCheckbox;
     QComboBox *audioCodecCombo;
     QSpinBox *audioBitrateInput;
+
+    QCheckBox *targetSizeCheckbox;
+    QSpinBox *targetSizeInput;
+    QPushButton *estimateButton;
+    QLabel *estimateLabel;
+    QPushButton *savePresetButton;
+    EncodeEstimator *estimator;
+    ExportPreviewButton *exportPreviewButton;
 };
 
 #endif // CONVERTDIALOG_H
\ No newline at end of file
@@ -10,7 +10,83 @@
 #include <QMouseEvent>
 #include <QProcess>
 #include <QFileDialog>
-#include <QMessageBox>
+#include <QResizeEvent>
+#include <QRegion>
+#include <QCheckBox>
+#include "FFmpegCapabilities.h"
+#include "ExportPreview.h"
+
+CropPreviewDecoder::CropPreviewDecoder(const QString &videoFile)
+    : framePending(false), videoFile(videoFile), process(nullptr)
+{
+}
+
+CropPreviewDecoder::~CropPreviewDecoder()
+{
+    stop();
+}
+
+void CropPreviewDecoder::start(const QSize &size, double startSeconds)
+{
+    stop();
+    if (size.isEmpty())
+        return;
+
+    frameSize = size;
+    framePending = false;
+
+    // Created here so the process and its pipe reads belong to the worker thread
+    process = new QProcess(this);
+    connect(process, &QProcess::readyReadStandardOutput, this, &CropPreviewDecoder::readFrames);
+
+    // Real-time paced, looping decode scaled down to exactly the size it is drawn at
+    QStringList args;
+    args << "-v" << "error"
+         << "-re"
+         << "-stream_loop" << "-1"
+         << "-ss" << QString::number(startSeconds)
+         << "-i" << videoFile
+         << "-an" << "-sn"
+         << "-vf" << QString("scale=%1:%2:flags=fast_bilinear").arg(size.width()).arg(size.height())
+         << "-pix_fmt" << "bgr0" // Byte layout of QImage::Format_RGB32 on little-endian hosts
+         << "-f" << "rawvideo" << "-";
+
+    process->start("ffmpeg", args);
+}
+
+void CropPreviewDecoder::stop()
+{
+    if (!process)
+        return;
+
+    process->disconnect(this);
+    process->kill();
+    process->waitForFinished(1000);
+    delete process;
+    process = nullptr;
+    buffer.clear();
+}
+
+void CropPreviewDecoder::readFrames()
+{
+    buffer.append(process->readAllStandardOutput());
+
+    const int frameBytes = frameSize.width() * frameSize.height() * 4;
+    int offset = 0;
+    while (buffer.size() - offset >= frameBytes)
+    {
+        // Drop the frame if the GUI is still behind; only the newest one matters
+        if (!framePending.exchange(true))
+        {
+            QImage frame(reinterpret_cast<const uchar *>(buffer.constData() + offset),
+                         frameSize.width(), frameSize.height(), frameSize.width() * 4,
+                         QImage::Format_RGB32);
+            emit frameReady(frame.copy());
+        }
+        offset += frameBytes;
+    }
+    buffer.remove(0, offset);
+}
 
 CropSelectionWidget::CropSelectionWidget(QWidget *parent) : QWidget(parent)
 {
@@ -19,6 +95,7 @@ CropSelectionWidget::CropSelectionWidget(QWidget *parent) : QWidget(parent)
 
     // Set default selection to full frame
     selectedRect = rect();
+    dimmedRect = selectedRect;
     rubberBand->setGeometry(selectedRect);
     rubberBand->show();
 
@@ -33,34 +110,80 @@ void CropSelectionWidget::setVideoFrame(const QPixmap &frame)
     // Calculate frame size to maintain aspect ratio
     if (!videoFrame.isNull())
     {
-        float widgetRatio = (float)width() / height();
-        float frameRatio = (float)videoFrame.width() / videoFrame.height();
-
-        if (frameRatio > widgetRatio)
-        {
-            // Width limited
-            frameRect.setWidth(width());
-            frameRect.setHeight(width() / frameRatio);
-            frameRect.moveTop((height() - frameRect.height()) / 2);
-            frameRect.moveLeft(0);
-        }
-        else
-        {
-            // Height limited
-            frameRect.setHeight(height());
-            frameRect.setWidth(height() * frameRatio);
-            frameRect.moveLeft((width() - frameRect.width()) / 2);
-            frameRect.moveTop(0);
-        }
+        updateFrameRect();
 
         // Reset selection to full frame
         selectedRect = frameRect;
+        dimmedRect = selectedRect;
         rubberBand->setGeometry(selectedRect);
     }
 
     update();
 }
 
+void CropSelectionWidget::setPreviewFrame(const QImage &frame)
+{
+    if (frameRect.isEmpty())
+        return;
+
+    // Frames normally arrive at display size already; rescale only after a resize race
+    scaledFrame = QPixmap::fromImage(frame.size() == frameRect.size()
+                                         ? frame
+                                         : frame.scaled(frameRect.size(), Qt::IgnoreAspectRatio,
+                                                        Qt::FastTransformation));
+    update(frameRect);
+}
+
+QSize CropSelectionWidget::getDisplaySize() const
+{
+    return frameRect.size();
+}
+
+void CropSelectionWidget::updateFrameRect()
+{
+    float widgetRatio = (float)width() / height();
+    float frameRatio = (float)videoFrame.width() / videoFrame.height();
+
+    if (frameRatio > widgetRatio)
+    {
+        // Width limited
+        frameRect.setWidth(width());
+        frameRect.setHeight(width() / frameRatio);
+        frameRect.moveTop((height() - frameRect.height()) / 2);
+        frameRect.moveLeft(0);
+    }
+    else
+    {
+        // Height limited
+        frameRect.setHeight(height());
+        frameRect.setWidth(height() * frameRatio);
+        frameRect.moveLeft((width() - frameRect.width()) / 2);
+        frameRect.moveTop(0);
+    }
+
+    // Scale once here rather than on every repaint
+    scaledFrame = videoFrame.scaled(frameRect.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+QRect CropSelectionWidget::toWidgetRect(const QRect &videoRect) const
+{
+    float xScale = (float)frameRect.width() / videoFrame.width();
+    float yScale = (float)frameRect.height() / videoFrame.height();
+
+    return QRect(frameRect.left() + qRound(videoRect.left() * xScale),
+                 frameRect.top() + qRound(videoRect.top() * yScale),
+                 qRound(videoRect.width() * xScale),
+                 qRound(videoRect.height() * yScale));
+}
+
+void CropSelectionWidget::setDimmedRect(const QRect &rect)
+{
+    // Only the strip between the old and new selection changes shade
+    QRegion dirty = QRegion(dimmedRect).xored(QRegion(rect));
+    dimmedRect = rect;
+    update(dirty);
+}
+
 QRect CropSelectionWidget::getSelectedRect() const
 {
     if (videoFrame.isNull() || frameRect.isEmpty())
@@ -85,17 +208,41 @@ QRect CropSelectionWidget::getSelectedRect() const
 void CropSelectionWidget::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
+    const QRect dirty = event->rect();
 
     // Fill background
-    painter.fillRect(rect(), Qt::black);
+    painter.fillRect(dirty, Qt::black);
 
-    // Draw video frame
-    if (!videoFrame.isNull())
+    // Draw only the damaged part of the pre-scaled frame
+    if (!scaledFrame.isNull())
     {
-        painter.drawPixmap(frameRect, videoFrame);
+        QRect target = dirty.intersected(frameRect);
+        if (!target.isEmpty())
+            painter.drawPixmap(target, scaledFrame, target.translated(-frameRect.topLeft()));
+
+        // Shade what will be cropped away
+        QRegion outside = QRegion(frameRect).subtracted(QRegion(dimmedRect)).intersected(event->region());
+        for (const QRect &area : outside)
+            painter.fillRect(area, QColor(0, 0, 0, 140));
     }
 }
 
+void CropSelectionWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    if (videoFrame.isNull())
+        return;
+
+    // Keep the same region of the video selected at the new scale
+    QRect videoSelection = getSelectedRect();
+    updateFrameRect();
+    selectedRect = toWidgetRect(videoSelection);
+    dimmedRect = selectedRect;
+    rubberBand->setGeometry(selectedRect);
+
+    emit displaySizeChanged();
+}
+
 void CropSelectionWidget::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton)
@@ -123,6 +270,7 @@ void CropSelectionWidget::mouseMoveEvent(QMouseEvent *event)
         rect = rect.intersected(frameRect);
 
         rubberBand->setGeometry(rect);
+        setDimmedRect(rect);
     }
 }
 
@@ -145,12 +293,14 @@ void CropSelectionWidget::mouseReleaseEvent(QMouseEvent *event)
         }
 
         rubberBand->setGeometry(selectedRect);
+        setDimmedRect(selectedRect);
         emit selectionChanged();
     }
 }
 
-CropDialog::CropDialog(const QString &videoFile, int videoWidth, int videoHeight, QWidget *parent)
-    : QDialog(parent), videoFile(videoFile), originalWidth(videoWidth), originalHeight(videoHeight)
+CropDialog::CropDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent)
+    : QDialog(parent), videoFile(videoFile), sourceInfo(info), originalWidth(info.width), originalHeight(info.height),
+      previewDecoder(new CropPreviewDecoder(videoFile)), previewPlaying(false)
 {
     setWindowTitle("Crop Video");
     resize(800, 600);
@@ -165,38 +315,71 @@ CropDialog::CropDialog(const QString &videoFile, int videoWidth, int videoHeight
     QFormLayout *formLayout = new QFormLayout();
 
     xInput = new QSpinBox(this);
-    xInput->setRange(0, videoWidth);
+    xInput->setRange(0, originalWidth);
     xInput->setSuffix(" px");
     formLayout->addRow("X:", xInput);
 
     yInput = new QSpinBox(this);
-    yInput->setRange(0, videoHeight);
+    yInput->setRange(0, originalHeight);
     yInput->setSuffix(" px");
     formLayout->addRow("Y:", yInput);
 
     widthInput = new QSpinBox(this);
-    widthInput->setRange(10, videoWidth);
-    widthInput->setValue(videoWidth);
+    widthInput->setRange(10, originalWidth);
+    widthInput->setValue(originalWidth);
     widthInput->setSuffix(" px");
     formLayout->addRow("Width:", widthInput);
 
     heightInput = new QSpinBox(this);
-    heightInput->setRange(10, videoHeight);
-    heightInput->setValue(videoHeight);
+    heightInput->setRange(10, originalHeight);
+    heightInput->setValue(originalHeight);
     heightInput->setSuffix(" px");
     formLayout->addRow("Height:", heightInput);
 
     mainLayout->addLayout(formLayout);
 
+    // Remux-only crop for H.264/HEVC when the edges line up with what the codec can signal
+    losslessCheckbox = new QCheckBox("Lossless crop (no re-encode)", this);
+    losslessCheckbox->setChecked(true);
+    losslessLabel = new QLabel(this);
+    losslessLabel->setWordWrap(true);
+    mainLayout->addWidget(losslessCheckbox);
+    mainLayout->addWidget(losslessLabel);
+
     // Load video frame for preview
     QLabel *loadingLabel = new QLabel("Loading video frame...", this);
     mainLayout->addWidget(loadingLabel);
 
+    // Live playback of the source with the crop region highlighted
+    playPreviewButton = new QPushButton("Play Preview", this);
+    playPreviewButton->setEnabled(false);
+    mainLayout->addWidget(playPreviewButton);
+
+    previewDecoder->moveToThread(&decoderThread);
+    connect(&decoderThread, &QThread::finished, previewDecoder, &QObject::deleteLater);
+    connect(previewDecoder, &CropPreviewDecoder::frameReady, this, [this](const QImage &frame)
+            {
+                selectionWidget->setPreviewFrame(frame);
+                previewDecoder->framePending = false;
+            });
+    decoderThread.start();
+
+    restartTimer.setSingleShot(true);
+    restartTimer.setInterval(300);
+    connect(&restartTimer, &QTimer::timeout, this, &CropDialog::restartPreview);
+    connect(selectionWidget, &CropSelectionWidget::displaySizeChanged,
+            &restartTimer, QOverload<>::of(&QTimer::start));
+    connect(playPreviewButton, &QPushButton::clicked, this, &CropDialog::togglePreviewPlayback);
+
     // Button box
     QDialogButtonBox *buttonBox = new QDialogButtonBox(
         QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    // Encodes a few seconds at the playhead with these settings and plays them in the main window
+    exportPreviewButton = new ExportPreviewButton(this);
+    buttonBox->addButton(exportPreviewButton, QDialogButtonBox::ActionRole);
     mainLayout->addWidget(buttonBox);
 
     // Update numeric values when selection changes
@@ -213,6 +396,11 @@ CropDialog::CropDialog(const QString &videoFile, int videoWidth, int videoHeight
     connect(heightInput, QOverload<int>::of(&QSpinBox::valueChanged),
             this, &CropDialog::validateDimensions);
 
+    for (QSpinBox *input : {xInput, yInput, widthInput, heightInput})
+        connect(input, QOverload<int>::of(&QSpinBox::valueChanged),
+                this, &CropDialog::updateLosslessAvailability);
+    updateLosslessAvailability();
+
     // Extract frame for preview using FFMPEG
     QProcess *ffmpeg = new QProcess(this);
 
@@ -228,6 +416,7 @@ CropDialog::CropDialog(const QString &videoFile, int videoWidth, int videoHeight
                     {
                         selectionWidget->setVideoFrame(frame);
                         loadingLabel->hide();
+                        playPreviewButton->setEnabled(true);
                     }
                     else
                     {
@@ -255,10 +444,38 @@ CropDialog::CropDialog(const QString &videoFile, int videoWidth, int videoHeight
 
 CropDialog::~CropDialog()
 {
+    // Stop the decoder on its own thread before the thread goes away
+    QMetaObject::invokeMethod(previewDecoder, &CropPreviewDecoder::stop, Qt::BlockingQueuedConnection);
+    decoderThread.quit();
+    decoderThread.wait();
+
     // Clean up temp file
     QFile::remove("temp_frame.jpg");
 }
 
+void CropDialog::togglePreviewPlayback()
+{
+    previewPlaying = !previewPlaying;
+    playPreviewButton->setText(previewPlaying ? "Pause Preview" : "Play Preview");
+
+    if (previewPlaying)
+        restartPreview();
+    else
+        QMetaObject::invokeMethod(previewDecoder, &CropPreviewDecoder::stop, Qt::QueuedConnection);
+}
+
+void CropDialog::restartPreview()
+{
+    if (!previewPlaying)
+        return;
+
+    // The decoder scales to the size the frame is drawn at, so a resize needs a restart
+    QSize size = selectionWidget->getDisplaySize();
+    CropPreviewDecoder *decoder = previewDecoder;
+    QMetaObject::invokeMethod(decoder, [decoder, size]()
+                              { decoder->start(size, 1.0); }, Qt::QueuedConnection);
+}
+
 int CropDialog::getX() const
 {
     return xInput->value();
@@ -282,6 +499,19 @@ int CropDialog::getHeight() const
 QStringList CropDialog::getFFMPEGArguments(const QString &outputFile) const
 {
     QStringList args;
+
+    if (isLosslessCrop())
+    {
+        // Only the SPS changes; every frame is copied as-is
+        args << "-y"
+             << "-i" << videoFile
+             << "-map" << "0:v:0" << "-map" << "0:a?"
+             << "-c" << "copy"
+             << "-bsf:v" << losslessCropFilter()
+             << outputFile;
+        return args;
+    }
+
     QString cropFilter = QString("crop=%1:%2:%3:%4")
                              .arg(getWidth())
                              .arg(getHeight())
@@ -297,6 +527,80 @@ QStringList CropDialog::getFFMPEGArguments(const QString &outputFile) const
     return args;
 }
 
+bool CropDialog::isLosslessCrop() const
+{
+    return losslessCheckbox->isChecked() && canCropLosslessly(nullptr);
+}
+
+bool CropDialog::canCropLosslessly(QString *reason) const
+{
+    QString bsf = sourceInfo.videoCodec + "_metadata";
+    if (sourceInfo.videoCodec != "h264" && sourceInfo.videoCodec != "hevc")
+    {
+        if (reason)
+            *reason = "Lossless crop needs H.264 or HEVC video";
+        return false;
+    }
+    if (!FFmpegCapabilities::instance().hasBitstreamFilter(bsf))
+    {
+        if (reason)
+            *reason = "This FFMPEG build lacks the " + bsf + " bitstream filter";
+        return false;
+    }
+
+    int right = originalWidth - getX() - getWidth();
+    int bottom = originalHeight - getY() - getHeight();
+
+    // The cropping window is signalled in chroma samples, so 4:2:0 needs even edges
+    if (getX() % 2 || getY() % 2 || right % 2 || bottom % 2)
+    {
+        if (reason)
+            *reason = "Lossless crop needs every edge on an even pixel";
+        return false;
+    }
+
+    // Decoders (ffmpeg's included) silently ignore left crops that would leave the
+    // picture unaligned in memory, so only allow ones that keep it aligned
+    if (getX() % 64)
+    {
+        if (reason)
+            *reason = "Lossless crop needs X to be a multiple of 64 (right, top and bottom edges are free)";
+        return false;
+    }
+
+    if (reason)
+        *reason = "The crop is written into the stream headers; frames are copied untouched";
+    return true;
+}
+
+QString CropDialog::losslessCropFilter() const
+{
+    // Offsets are measured from the coded picture, which already carries the
+    // encoder's own padding crop (e.g. 1080p H.264 is coded as 1088 rows)
+    int alignment = sourceInfo.videoCodec == "h264" ? 16 : 8;
+    int codedWidth = sourceInfo.codedWidth >= originalWidth ? sourceInfo.codedWidth
+                                                            : (originalWidth + alignment - 1) / alignment * alignment;
+    int codedHeight = sourceInfo.codedHeight >= originalHeight ? sourceInfo.codedHeight
+                                                               : (originalHeight + alignment - 1) / alignment * alignment;
+
+    int right = codedWidth - getX() - getWidth();
+    int bottom = codedHeight - getY() - getHeight();
+
+    return QString("%1_metadata=crop_left=%2:crop_right=%3:crop_top=%4:crop_bottom=%5")
+        .arg(sourceInfo.videoCodec)
+        .arg(getX())
+        .arg(right)
+        .arg(getY())
+        .arg(bottom);
+}
+
+void CropDialog::updateLosslessAvailability()
+{
+    QString reason;
+    losslessCheckbox->setEnabled(canCropLosslessly(&reason));
+    losslessLabel->setText(reason);
+}
+
 void CropDialog::validateDimensions()
 {
     // Ensure crop area stays within video boundaries
@@ -330,4 +634,10 @@ void CropDialog::updateInputsFromSelection()
     yInput->blockSignals(false);
     widthInput->blockSignals(false);
     heightInput->blockSignals(false);
-}
\ No newline at end of file
+}
+
+void CropDialog::setExportPreview(ExportPreview *preview)
+{
+    exportPreviewButton->setPreview(preview, [this](const QString &outputFile)
+                                    { return getFFMPEGArguments(outputFile); });
+}
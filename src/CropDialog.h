@@ -10,7 +10,49 @@
 #include <QRect>
 #include <QPoint>
 #include <QPixmap>
+#include <QImage>
 #include <QWidget>
+#include <QPushButton>
+#include <QThread>
+#include <QTimer>
+#include <QByteArray>
+#include <atomic>
+#include "MediaProbe.h"
+
+class QProcess;
+class QCheckBox;
+class ExportPreview;
+class ExportPreviewButton;
+
+// Decodes the source at display resolution for the live crop preview. Lives on
+// a worker thread; frames the GUI has not drawn yet are dropped, not queued.
+class CropPreviewDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    CropPreviewDecoder(const QString &videoFile);
+    ~CropPreviewDecoder();
+
+    // Cleared by the GUI once it has drawn the last delivered frame
+    std::atomic<bool> framePending;
+
+public slots:
+    void start(const QSize &size, double startSeconds);
+    void stop();
+
+signals:
+    void frameReady(const QImage &frame);
+
+private slots:
+    void readFrames();
+
+private:
+    QString videoFile;
+    QProcess *process;
+    QSize frameSize;
+    QByteArray buffer;
+};
 
 // Custom widget for visual crop selection
 class CropSelectionWidget : public QWidget
@@ -21,21 +63,31 @@ public:
     CropSelectionWidget(QWidget *parent = nullptr);
 
     void setVideoFrame(const QPixmap &frame);
+    void setPreviewFrame(const QImage &frame);
     QRect getSelectedRect() const;
+    QSize getDisplaySize() const;
 
 signals:
     void selectionChanged();
+    void displaySizeChanged();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
 
 private:
-    QPixmap videoFrame;
-    QRect frameRect;    // Rect where the frame is drawn
-    QRect selectedRect; // Selected area in widget coordinates
+    void updateFrameRect();
+    QRect toWidgetRect(const QRect &videoRect) const;
+    void setDimmedRect(const QRect &rect);
+
+    QPixmap videoFrame;  // Full-resolution still, defines the video coordinates
+    QPixmap scaledFrame; // Current frame already scaled to frameRect, reused by every repaint
+    QRect frameRect;     // Rect where the frame is drawn
+    QRect selectedRect;  // Selected area in widget coordinates
+    QRect dimmedRect;    // Area left undimmed, follows the rubber band while dragging
     QRubberBand *rubberBand;
     QPoint origin;
     bool isSelecting;
@@ -46,7 +98,7 @@ class CropDialog : public QDialog
     Q_OBJECT
 
 public:
-    CropDialog(const QString &videoFile, int videoWidth, int videoHeight, QWidget *parent = nullptr);
+    CropDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent = nullptr);
     ~CropDialog();
 
     int getX() const;
@@ -55,13 +107,26 @@ public:
     int getHeight() const;
     QStringList getFFMPEGArguments(const QString &outputFile) const;
 
+    // True when the crop is applied by rewriting the SPS cropping window (a remux)
+    bool isLosslessCrop() const;
+
+    // Shows the Preview Result button, which encodes through this preview
+    void setExportPreview(ExportPreview *preview);
+
 private slots:
     void validateDimensions();
     void updatePreview();
     void updateInputsFromSelection();
+    void togglePreviewPlayback();
+    void restartPreview();
+    void updateLosslessAvailability();
 
 private:
+    bool canCropLosslessly(QString *reason) const;
+    QString losslessCropFilter() const;
+
     QString videoFile;
+    MediaInfo sourceInfo;
     int originalWidth;
     int originalHeight;
 
@@ -71,6 +136,16 @@ private:
     QSpinBox *widthInput;
     QSpinBox *heightInput;
     QLabel *previewLabel;
+    QCheckBox *losslessCheckbox;
+    QLabel *losslessLabel;
+    QPushButton *playPreviewButton;
+
+    QThread decoderThread;
+    CropPreviewDecoder *previewDecoder;
+    QTimer restartTimer; // Debounces decoder restarts while the dialog is resized
+    bool previewPlaying;
+
+    ExportPreviewButton *exportPreviewButton;
 };
 
 #endif // CROPDIALOG_H
\ No newline at end of file
@@ -0,0 +1,502 @@
+#include "DistributedEncoder.h"
+#include "MessageChannel.h"
+#include "FFmpegPipeline.h"
+#include "FFmpegLog.h"
+#include <QTcpSocket>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <algorithm>
+
+namespace
+{
+    const int segmentSeconds = 20;
+    const int maxAttempts = 3;
+    const int maxRetries = 10;
+    const int maxWorkerFailures = 3; // In a row, before a worker is written off
+    const int retryDelayMs = 2000;   // Times the worker's failures in a row
+    const int connectTimeoutMs = 10000;
+    const double stragglerFactor = 2.0; // Duplicate segments running this much longer than the median
+}
+
+DistributedEncoder::DistributedEncoder(FFmpegLog *log, QObject *parent)
+    : QObject(parent), log(log), pipeline(nullptr), workDir(nullptr), running(false)
+{
+    // Also picks up workers coming out of a retry back-off
+    stragglerTimer.setInterval(2000);
+    connect(&stragglerTimer, &QTimer::timeout, this, &DistributedEncoder::dispatch);
+}
+
+DistributedEncoder::~DistributedEncoder()
+{
+    cancel();
+}
+
+QStringList DistributedEncoder::parseWorkers(const QString &list, QString *error)
+{
+    QStringList result;
+    static const QRegularExpression separators("[,\\s]+");
+    for (const QString &entry : list.split(separators, Qt::SkipEmptyParts))
+    {
+        // "host", "host:port" or "[ipv6]:port"
+        QString host = entry;
+        int port = MessageChannel::defaultPort;
+        int colon = entry.lastIndexOf(':');
+        bool bracketed = entry.startsWith('[');
+        if (colon > 0 && (bracketed ? entry.at(colon - 1) == ']' : entry.indexOf(':') == colon))
+        {
+            bool ok = false;
+            port = entry.mid(colon + 1).toInt(&ok);
+            if (!ok || port < 1 || port > 65535)
+            {
+                if (error)
+                    *error = "Invalid port in worker address: " + entry;
+                return QStringList();
+            }
+            host = entry.left(colon);
+        }
+        if (bracketed)
+            host = host.mid(1, host.size() - 2);
+
+        result << QString("%1:%2").arg(host.contains(':') ? "[" + host + "]" : host).arg(port);
+    }
+
+    if (result.isEmpty() && error)
+        *error = "No worker addresses given";
+    return result;
+}
+
+bool DistributedEncoder::isSupported(const QString &format)
+{
+    // Single-file containers the segments can be stream-copied back into
+    return format == "mp4" || format == "mov" || format == "mkv" || format == "webm";
+}
+
+void DistributedEncoder::start(const QString &source, const ConvertDialog::Settings &convertSettings,
+                               const QString &output, const QStringList &addresses, const QByteArray &workerToken)
+{
+    cancel();
+
+    sourceFile = source;
+    outputFile = output;
+    settings = convertSettings;
+    workerAddresses = addresses;
+    token = workerToken;
+    segments.clear();
+    segmentTimes.clear();
+    running = true;
+    workDir = new QTemporaryDir();
+
+    split();
+}
+
+void DistributedEncoder::cancel()
+{
+    running = false;
+    stragglerTimer.stop();
+
+    delete pipeline;
+    pipeline = nullptr;
+
+    for (Worker &worker : workers)
+    {
+        if (!worker.channel)
+            continue;
+        worker.channel->disconnect(this);
+        worker.channel->deleteLater();
+    }
+    workers.clear();
+
+    delete workDir;
+    workDir = nullptr;
+}
+
+void DistributedEncoder::split()
+{
+    emit progress("Splitting the source at keyframes...");
+
+    // Stream copy only cuts at keyframes, so every segment decodes on its own
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName() + " (split)", this);
+    pipeline->addStep(QStringList() << "-y"
+                                    << "-i" << sourceFile
+                                    << "-map" << "0:v:0" << "-c" << "copy"
+                                    << "-f" << "segment"
+                                    << "-segment_time" << QString::number(segmentSeconds)
+                                    << "-segment_format" << "matroska"
+                                    << "-reset_timestamps" << "1"
+                                    << workDir->path() + "/segment%05d.mkv");
+
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+                if (!success)
+                {
+                    fail("Splitting failed: " + error);
+                    return;
+                }
+
+                QDir dir(workDir->path());
+                for (const QString &name : dir.entryList(QStringList() << "segment*.mkv", QDir::Files, QDir::Name))
+                {
+                    Segment segment;
+                    segment.file = dir.filePath(name);
+                    segment.result = dir.filePath(QString("encoded%1.%2")
+                                                      .arg(segments.size(), 5, 10, QChar('0'))
+                                                      .arg(ConvertDialog::extensionForFormat(settings.format)));
+                    segment.attempts = 0;
+                    segment.retries = 0;
+                    segment.done = false;
+                    segments.append(segment);
+                }
+
+                if (segments.isEmpty())
+                {
+                    fail("The source has no video to encode");
+                    return;
+                }
+                connectWorkers();
+            });
+    pipeline->start();
+}
+
+void DistributedEncoder::connectWorkers()
+{
+    for (const QString &address : workerAddresses)
+    {
+        int colon = address.lastIndexOf(':');
+        QString host = address.left(colon);
+        if (host.startsWith('['))
+            host = host.mid(1, host.size() - 2);
+        quint16 port = quint16(address.mid(colon + 1).toInt());
+
+        int index = workers.size();
+        QTcpSocket *socket = new QTcpSocket();
+        Worker worker;
+        worker.address = address;
+        worker.channel = new MessageChannel(socket, this);
+        worker.capacity = 0;
+        worker.busy = 0;
+        worker.failures = 0;
+        worker.restUntil = 0;
+        worker.alive = true;
+        workers.append(worker);
+
+        connect(worker.channel, &MessageChannel::received, this,
+                [this, index](const QJsonObject &message, const QByteArray &payload)
+                { handleMessage(index, message, payload); });
+        connect(worker.channel, &MessageChannel::closed, this, [this, index](const QString &reason)
+                { workerLost(index, reason); });
+
+        socket->connectToHost(host, port);
+    }
+
+    // Workers that never answer are written off instead of holding up the job
+    QTimer::singleShot(connectTimeoutMs, this, [this]()
+                       {
+        for (int i = 0; i < workers.size(); ++i)
+        {
+            if (workers[i].alive && workers[i].capacity == 0)
+                workerLost(i, "No answer");
+        } });
+
+    emit progress(QString("Connecting to %1 worker(s)...").arg(workers.size()));
+    stragglerTimer.start();
+}
+
+void DistributedEncoder::handleMessage(int index, const QJsonObject &message, const QByteArray &payload)
+{
+    Worker &worker = workers[index];
+    QString type = message["type"].toString();
+
+    if (type == "hello")
+    {
+        if (message["version"].toInt() != MessageChannel::protocolVersion)
+        {
+            workerLost(index, "Incompatible worker version");
+            return;
+        }
+
+        // Messages are handled in order, so the worker sees this before any segment
+        QJsonObject auth;
+        auth["type"] = "auth";
+        auth["response"] = QString::fromLatin1(
+            MessageChannel::authResponse(token, message["challenge"].toString().toLatin1()));
+        worker.channel->send(auth);
+
+        worker.capacity = qMax(1, message["jobs"].toInt());
+        dispatch();
+        return;
+    }
+
+    if (type == "denied")
+    {
+        workerLost(index, "Worker rejected the token");
+        return;
+    }
+
+    if (type != "result")
+        return;
+
+    int id = message["id"].toInt();
+    if (id < 0 || id >= segments.size())
+        return;
+
+    // Late answers for a duplicate that was already cancelled are ignored
+    Segment &segment = segments[id];
+    if (!segment.runningOn.removeOne(index))
+        return;
+    worker.busy--;
+
+    if (message["ok"].toBool())
+    {
+        worker.failures = 0;
+        if (!segment.done)
+        {
+            QFile result(segment.result);
+            if (!result.open(QIODevice::WriteOnly) || result.write(payload) != payload.size())
+            {
+                fail("Cannot write " + segment.result);
+                return;
+            }
+
+            segment.done = true;
+            segmentTimes.append(segment.started.elapsed());
+
+            // First result wins; stop the duplicates
+            for (int other : segment.runningOn)
+            {
+                QJsonObject cancelMessage;
+                cancelMessage["type"] = "cancel";
+                cancelMessage["id"] = id;
+                workers[other].channel->send(cancelMessage);
+                workers[other].busy--;
+            }
+            segment.runningOn.clear();
+        }
+    }
+    else
+    {
+        QString error = message["error"].toString();
+        bool retry = message["retry"].toBool();
+        if (retry ? ++segment.retries >= maxRetries : ++segment.attempts >= maxAttempts)
+        {
+            fail(QString("Segment %1 failed %2 times: %3").arg(id).arg(retry ? segment.retries : segment.attempts).arg(error));
+            return;
+        }
+
+        // A worker that keeps failing is written off; until then it waits longer after each failure
+        if (++worker.failures >= maxWorkerFailures)
+        {
+            workerLost(index, QString("Failed %1 segments in a row: %2").arg(worker.failures).arg(error));
+            return;
+        }
+        worker.restUntil = QDateTime::currentMSecsSinceEpoch() + qint64(retryDelayMs) * worker.failures;
+    }
+
+    for (const Segment &each : segments)
+    {
+        if (!each.done)
+        {
+            reportProgress();
+            dispatch();
+            return;
+        }
+    }
+    concatenate();
+}
+
+void DistributedEncoder::workerLost(int index, const QString &reason)
+{
+    if (!running || !workers[index].alive)
+        return;
+
+    Worker &worker = workers[index];
+    worker.alive = false;
+    worker.busy = 0;
+    worker.channel->disconnect(this);
+    worker.channel->deleteLater();
+    worker.channel = nullptr;
+    emit progress("Worker " + worker.address + " dropped: " + reason);
+
+    // Its segments go back in the queue
+    for (Segment &segment : segments)
+        segment.runningOn.removeAll(index);
+
+    bool anyAlive = false;
+    for (const Worker &each : workers)
+        anyAlive = anyAlive || each.alive;
+    if (!anyAlive)
+    {
+        fail("No workers left (last: " + worker.address + ": " + reason + ")");
+        return;
+    }
+    dispatch();
+}
+
+void DistributedEncoder::dispatch()
+{
+    if (!running || pipeline)
+        return;
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < workers.size(); ++i)
+    {
+        if (workers[i].restUntil > now)
+            continue;
+
+        while (workers[i].alive && workers[i].busy < workers[i].capacity)
+        {
+            int segment = nextSegment(i);
+            if (segment < 0)
+                break;
+            send(i, segment);
+
+            // send() fails the whole job when a segment can't be read, which clears the workers
+            if (!running)
+                return;
+        }
+    }
+    reportProgress();
+}
+
+int DistributedEncoder::nextSegment(int worker) const
+{
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        if (!segments[i].done && segments[i].runningOn.isEmpty())
+            return i;
+    }
+
+    // Nothing left to hand out: give an idle worker a copy of the slowest straggler
+    if (segmentTimes.isEmpty())
+        return -1;
+    QVector<qint64> times = segmentTimes;
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    qint64 median = times[times.size() / 2];
+
+    int slowest = -1;
+    qint64 slowestTime = qint64(median * stragglerFactor);
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        const Segment &segment = segments[i];
+        if (segment.done || segment.runningOn.size() != 1 || segment.runningOn.contains(worker))
+            continue;
+        if (segment.started.elapsed() > slowestTime)
+        {
+            slowest = i;
+            slowestTime = segment.started.elapsed();
+        }
+    }
+    return slowest;
+}
+
+void DistributedEncoder::send(int worker, int index)
+{
+    Segment &segment = segments[index];
+    QFile file(segment.file);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        fail("Cannot read " + segment.file);
+        return;
+    }
+    if (file.size() > MessageChannel::maxSegmentBytes)
+    {
+        fail(QString("Segment %1 is %2 MB, more than workers accept (%3 MB)")
+                 .arg(index)
+                 .arg(file.size() >> 20)
+                 .arg(MessageChannel::maxSegmentBytes >> 20));
+        return;
+    }
+
+    QJsonObject message;
+    message["type"] = "encode";
+    message["id"] = index;
+    message["settings"] = settings.toJson();
+    workers[worker].channel->send(message, file.readAll());
+
+    if (segment.runningOn.isEmpty())
+        segment.started.start();
+    segment.runningOn.append(worker);
+    workers[worker].busy++;
+}
+
+void DistributedEncoder::reportProgress()
+{
+    int done = 0;
+    for (const Segment &segment : segments)
+        done += segment.done ? 1 : 0;
+
+    int alive = 0;
+    for (const Worker &worker : workers)
+        alive += worker.alive && worker.capacity > 0 ? 1 : 0;
+
+    emit progress(QString("Encoding on %1 worker(s): %2 of %3 segments").arg(alive).arg(done).arg(segments.size()));
+}
+
+void DistributedEncoder::concatenate()
+{
+    stragglerTimer.stop();
+    for (Worker &worker : workers)
+    {
+        if (!worker.channel)
+            continue;
+        worker.channel->disconnect(this);
+        worker.channel->deleteLater();
+    }
+    workers.clear();
+
+    QString listFile = workDir->path() + "/segments.txt";
+    QFile list(listFile);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        fail("Could not write the segment list");
+        return;
+    }
+    QTextStream stream(&list);
+    for (const Segment &segment : segments)
+        stream << "file '" << QString(segment.result).replace("'", "'\\''") << "'\n";
+    list.close();
+
+    // Video as encoded by the workers, audio encoded here once so there are no gaps at the joins
+    QStringList args;
+    args << "-y"
+         << "-f" << "concat" << "-safe" << "0" << "-i" << listFile
+         << "-i" << sourceFile
+         << "-map" << "0:v" << "-map" << "1:a?"
+         << "-c:v" << "copy";
+    if (settings.convertAudio)
+        args << "-c:a" << settings.audioCodec << "-b:a" << QString::number(settings.audioBitrate) + "k";
+    else
+        args << "-an";
+    args << outputFile;
+
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName(), this);
+    pipeline->addStep(args);
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+                running = false;
+                delete workDir;
+                workDir = nullptr;
+                emit finished(success, error);
+            });
+
+    emit progress("Joining segments...");
+    pipeline->start();
+}
+
+void DistributedEncoder::fail(const QString &error)
+{
+    if (!running)
+        return;
+
+    cancel();
+    emit finished(false, error);
+}
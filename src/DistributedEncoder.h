@@ -0,0 +1,95 @@
+#ifndef DISTRIBUTEDENCODER_H
+#define DISTRIBUTEDENCODER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QTemporaryDir>
+#include "ConvertDialog.h"
+
+class FFmpegLog;
+class FFmpegPipeline;
+class MessageChannel;
+
+// Coordinator for encoding on worker processes (see EncodeWorker). The source's
+// video is split by stream copy into keyframe-aligned segments, which are handed
+// out to the workers with the ConvertDialog settings. Failed segments are retried
+// elsewhere, the slowest ones are duplicated onto idle workers near the end, and
+// the results are joined by stream copy with the audio encoded once locally.
+class DistributedEncoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    DistributedEncoder(FFmpegLog *log, QObject *parent = nullptr);
+    ~DistributedEncoder();
+
+    // "host:port" entries separated by commas or spaces; the port defaults to MessageChannel::defaultPort
+    static QStringList parseWorkers(const QString &list, QString *error);
+    static bool isSupported(const QString &format);
+
+    // token is the secret the workers were started with
+    void start(const QString &sourceFile, const ConvertDialog::Settings &settings,
+               const QString &outputFile, const QStringList &workers, const QByteArray &token);
+    void cancel();
+
+signals:
+    void progress(const QString &status);
+    void finished(bool success, const QString &error);
+
+private:
+    struct Segment
+    {
+        QString file;
+        QString result;
+        int attempts;
+        int retries; // Failures that weren't the segment's fault, e.g. a worker out of disk
+        bool done;
+        QList<int> runningOn; // Worker indices
+        QElapsedTimer started;
+    };
+
+    struct Worker
+    {
+        QString address;
+        MessageChannel *channel; // Null once the worker is gone
+        int capacity; // 0 until the worker has said hello
+        int busy;
+        int failures;      // In a row; reset by a success
+        qint64 restUntil;  // Epoch milliseconds; no new segments before then
+        bool alive;
+    };
+
+    void split();
+    void connectWorkers();
+    void handleMessage(int worker, const QJsonObject &message, const QByteArray &payload);
+    void workerLost(int worker, const QString &reason);
+    void dispatch();
+    int nextSegment(int worker) const;
+    void send(int worker, int segment);
+    void reportProgress();
+    void concatenate();
+    void fail(const QString &error);
+
+    FFmpegLog *log;
+    FFmpegPipeline *pipeline;
+    QTemporaryDir *workDir;
+    QTimer stragglerTimer;
+
+    QString sourceFile;
+    QString outputFile;
+    ConvertDialog::Settings settings;
+    QStringList workerAddresses;
+    QByteArray token;
+
+    QList<Segment> segments;
+    QList<Worker> workers;
+    QVector<qint64> segmentTimes; // Milliseconds for each finished segment
+    bool running;
+};
+
+#endif // DISTRIBUTEDENCODER_H
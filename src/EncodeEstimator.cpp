@@ -0,0 +1,118 @@
+#include "EncodeEstimator.h"
+#include "FFmpegArguments.h"
+#include <QProcess>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+EncodeEstimator::EncodeEstimator(QObject *parent)
+    : QObject(parent), workDir(nullptr), durationSeconds(0), sampledSeconds(0)
+{
+}
+
+EncodeEstimator::~EncodeEstimator()
+{
+    cancel();
+}
+
+void EncodeEstimator::start(double duration, const QString &extension, ArgumentBuilder buildArguments)
+{
+    cancel();
+    if (duration <= 0)
+    {
+        emit failed("Unknown video duration");
+        return;
+    }
+
+    durationSeconds = duration;
+    workDir = new QTemporaryDir();
+
+    // Short sources are sampled in a single window covering everything
+    int windows = duration > windowCount * windowSeconds * 2 ? windowCount : 1;
+    double length = windows == 1 ? duration : windowSeconds;
+    sampledSeconds = windows * length;
+
+    wallClock.start();
+    for (int i = 0; i < windows; ++i)
+    {
+        // Centre each window in its share of the timeline
+        double start = windows == 1 ? 0.0 : (i + 0.5) * duration / windows - length / 2;
+
+        // Separate directories so segmented outputs (HLS/DASH) can be summed per window
+        QString windowDir = workDir->path() + QString("/window%1").arg(i);
+        QDir().mkpath(windowDir);
+        QString outputFile = windowDir + "/sample." + extension;
+
+        QStringList args = FFmpegArguments::withInputWindow(buildArguments(outputFile), start, length);
+
+        QProcess *process = new QProcess(this);
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, process](int exitCode, QProcess::ExitStatus exitStatus)
+                { windowFinished(process, exitCode); });
+
+        running.append(process);
+        process->start("ffmpeg", QStringList() << "-v" << "error" << args);
+    }
+}
+
+void EncodeEstimator::cancel()
+{
+    for (QProcess *process : running)
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+    running.clear();
+
+    delete workDir;
+    workDir = nullptr;
+}
+
+bool EncodeEstimator::isRunning() const
+{
+    return !running.isEmpty();
+}
+
+void EncodeEstimator::windowFinished(QProcess *process, int exitCode)
+{
+    running.removeOne(process);
+    process->deleteLater();
+
+    if (exitCode != 0)
+    {
+        QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        cancel();
+        emit failed(error.isEmpty() ? "Sample encode failed" : error);
+        return;
+    }
+
+    if (!running.isEmpty())
+        return;
+
+    // The samples ran side by side like a full encode would use every core,
+    // so content-seconds per wall-second carries over directly
+    double wallSeconds = wallClock.elapsed() / 1000.0;
+    qint64 sampledBytes = directorySize(workDir->path());
+
+    qint64 estimatedBytes = qint64(double(sampledBytes) / sampledSeconds * durationSeconds);
+    double estimatedSeconds = wallSeconds / sampledSeconds * durationSeconds;
+    double measuredKbps = sampledBytes * 8.0 / 1000.0 / sampledSeconds;
+
+    delete workDir;
+    workDir = nullptr;
+
+    emit estimated(estimatedBytes, estimatedSeconds, measuredKbps);
+}
+
+qint64 EncodeEstimator::directorySize(const QString &path)
+{
+    qint64 total = 0;
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
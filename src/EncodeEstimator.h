@@ -0,0 +1,50 @@
+#ifndef ENCODEESTIMATOR_H
+#define ENCODEESTIMATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <functional>
+
+class QProcess;
+
+// Estimates output size and encode time by encoding a few short windows spread
+// across the source in parallel with the real settings, then extrapolating.
+class EncodeEstimator : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Builds the full ffmpeg argument list for a given output file
+    typedef std::function<QStringList(const QString &outputFile)> ArgumentBuilder;
+
+    explicit EncodeEstimator(QObject *parent = nullptr);
+    ~EncodeEstimator();
+
+    void start(double durationSeconds, const QString &extension, ArgumentBuilder buildArguments);
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    // Extrapolated to the whole source; measuredKbps is the sampled total bitrate
+    void estimated(qint64 estimatedBytes, double estimatedSeconds, double measuredKbps);
+    void failed(const QString &error);
+
+private:
+    static const int windowCount = 4;
+    static const int windowSeconds = 5;
+
+    void windowFinished(QProcess *process, int exitCode);
+    static qint64 directorySize(const QString &path);
+
+    QList<QProcess *> running;
+    QTemporaryDir *workDir;
+    QElapsedTimer wallClock;
+    double durationSeconds;
+    double sampledSeconds;
+};
+
+#endif // ENCODEESTIMATOR_H
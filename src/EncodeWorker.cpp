@@ -0,0 +1,241 @@
+#include "EncodeWorker.h"
+#include "MessageChannel.h"
+#include "ConvertDialog.h"
+#include "FFmpegLog.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QSysInfo>
+#include <QRandomGenerator>
+#include <QDebug>
+
+EncodeWorker::EncodeWorker(int maxJobs, const QByteArray &token, QObject *parent)
+    : QObject(parent), maxJobs(qMax(1, maxJobs)), token(token), log(new FFmpegLog(500, this))
+{
+    connect(&server, &QTcpServer::newConnection, this, &EncodeWorker::acceptConnections);
+}
+
+EncodeWorker::~EncodeWorker()
+{
+    stopJobs(nullptr);
+}
+
+bool EncodeWorker::listen(const QHostAddress &address, quint16 port, QString *error)
+{
+    if (!server.listen(address, port))
+    {
+        if (error)
+            *error = "Cannot listen on " + address.toString() + ":" + QString::number(port) + ": " + server.errorString();
+        return false;
+    }
+
+    qInfo().noquote() << "Encode worker listening on" << address.toString() + ":" + QString::number(server.serverPort())
+                      << "with" << maxJobs << "job slot(s)";
+    return true;
+}
+
+void EncodeWorker::acceptConnections()
+{
+    while (QTcpSocket *socket = server.nextPendingConnection())
+    {
+        MessageChannel *channel = new MessageChannel(socket, this);
+        qInfo().noquote() << "Coordinator connected from" << channel->peerName();
+
+        // Nothing but the answer to a fresh challenge is accepted until it authenticates
+        quint64 nonce[4];
+        QRandomGenerator::system()->fillRange(nonce);
+        QByteArray challenge = QByteArray(reinterpret_cast<const char *>(nonce), sizeof(nonce)).toHex();
+        challenges.insert(channel, challenge);
+        channel->setMaxPayloadBytes(0);
+
+        connect(channel, &MessageChannel::received, this,
+                [this, channel](const QJsonObject &message, const QByteArray &payload)
+                { handleMessage(channel, message, payload); });
+        connect(channel, &MessageChannel::closed, this, [this, channel](const QString &)
+                {
+            stopJobs(channel);
+            challenges.remove(channel);
+            channel->disconnect(this);
+            channel->deleteLater(); });
+
+        QJsonObject hello;
+        hello["type"] = "hello";
+        hello["version"] = MessageChannel::protocolVersion;
+        hello["jobs"] = maxJobs;
+        hello["host"] = QSysInfo::machineHostName();
+        hello["challenge"] = QString::fromLatin1(challenge);
+        channel->send(hello);
+    }
+}
+
+void EncodeWorker::handleMessage(MessageChannel *channel, const QJsonObject &message, const QByteArray &payload)
+{
+    if (challenges.contains(channel))
+    {
+        // An emptied challenge marks a rejected coordinator whose connection is closing
+        if (!challenges[channel].isEmpty() && !authenticate(channel, message))
+        {
+            qWarning().noquote() << "Rejected coordinator" << channel->peerName() << "(wrong token)";
+            challenges[channel].clear();
+            QJsonObject denied;
+            denied["type"] = "denied";
+            channel->send(denied);
+            channel->socket()->disconnectFromHost();
+        }
+        return;
+    }
+
+    QString type = message["type"].toString();
+    if (type == "encode")
+        startJob(channel, message, payload);
+    else if (type == "cancel")
+        stopJobs(channel, message["id"].toInt());
+}
+
+bool EncodeWorker::authenticate(MessageChannel *channel, const QJsonObject &message)
+{
+    if (message["type"].toString() != "auth" ||
+        message["response"].toString().toLatin1() != MessageChannel::authResponse(token, challenges[channel]))
+        return false;
+
+    challenges.remove(channel);
+    channel->setMaxPayloadBytes(MessageChannel::maxSegmentBytes);
+    qInfo().noquote() << "Coordinator" << channel->peerName() << "authenticated";
+    return true;
+}
+
+void EncodeWorker::startJob(MessageChannel *channel, const QJsonObject &message, const QByteArray &payload)
+{
+    int id = message["id"].toInt();
+    if (jobs.size() >= maxJobs)
+    {
+        sendFailure(channel, id, "Worker is busy", true);
+        return;
+    }
+
+    // Only single-file containers; playlists and GIFs can't be joined from segments
+    ConvertDialog::Settings settings = ConvertDialog::Settings::fromJson(message["settings"].toObject());
+    if (settings.format != "mp4" && settings.format != "mov" && settings.format != "mkv" && settings.format != "webm")
+    {
+        sendFailure(channel, id, "Unsupported format for segment encoding: " + settings.format, false);
+        return;
+    }
+    settings.convertAudio = false; // Audio is encoded once by the coordinator
+    settings.sceneAdaptive = false;
+
+    QTemporaryDir *workDir = new QTemporaryDir();
+    QString inputFile = workDir->path() + "/input.mkv";
+    QString outputFile = workDir->path() + "/output." + ConvertDialog::extensionForFormat(settings.format);
+
+    QFile input(inputFile);
+    if (!input.open(QIODevice::WriteOnly) || input.write(payload) != payload.size())
+    {
+        delete workDir;
+        sendFailure(channel, id, "Cannot store the segment: " + input.errorString(), true);
+        return;
+    }
+    input.close();
+
+    QProcess *process = new QProcess(this);
+    Job job;
+    job.channel = channel;
+    job.id = id;
+    job.process = process;
+    job.workDir = workDir;
+    job.outputFile = outputFile;
+    jobs.insert(process, job);
+
+    log->attach(process, QString("segment %1").arg(id));
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, process](int exitCode, QProcess::ExitStatus exitStatus)
+            { finishJob(process, exitStatus == QProcess::NormalExit ? exitCode : -1); });
+
+    // finished never follows a failed start, so without this the slot would stay taken
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error)
+            {
+                if (error != QProcess::FailedToStart || !jobs.contains(process))
+                    return;
+                Job job = jobs.take(process);
+                process->deleteLater();
+                delete job.workDir;
+                qWarning().noquote() << "Could not start ffmpeg:" << process->errorString();
+                sendFailure(job.channel, job.id, "Could not start ffmpeg: " + process->errorString(), true);
+            });
+
+    // The payload is only trusted to be a segment: ffmpeg must not probe it as some
+    // other format, and nothing in it may make ffmpeg open anything but local files
+    QStringList args = ConvertDialog::buildArguments(inputFile, settings, outputFile);
+    int inputIndex = args.indexOf("-i");
+    QStringList inputOptions;
+    inputOptions << "-f" << "matroska" << "-protocol_whitelist" << "file";
+    for (int i = inputOptions.size() - 1; i >= 0; --i)
+        args.insert(inputIndex, inputOptions[i]);
+
+    qInfo().noquote() << "Encoding segment" << id << "for" << channel->peerName();
+    process->start("ffmpeg", FFmpegLog::loggingArguments() << "-nostdin" << args);
+}
+
+void EncodeWorker::finishJob(QProcess *process, int exitCode)
+{
+    Job job = jobs.take(process);
+    process->deleteLater();
+
+    if (exitCode != 0)
+    {
+        QString error = log->lastError(process);
+        qWarning().noquote() << "Segment" << job.id << "failed:" << error;
+        sendFailure(job.channel, job.id, error.isEmpty() ? "ffmpeg failed" : error, false);
+    }
+    else
+    {
+        QFile output(job.outputFile);
+        if (!output.open(QIODevice::ReadOnly))
+        {
+            sendFailure(job.channel, job.id, "Cannot read the encoded segment", true);
+        }
+        else
+        {
+            QJsonObject result;
+            result["type"] = "result";
+            result["id"] = job.id;
+            result["ok"] = true;
+            job.channel->send(result, output.readAll());
+            qInfo().noquote() << "Finished segment" << job.id;
+        }
+    }
+
+    delete job.workDir;
+}
+
+void EncodeWorker::stopJobs(MessageChannel *channel, int id)
+{
+    // A null channel stops everything; otherwise one coordinator's jobs, or one of them
+    for (auto it = jobs.begin(); it != jobs.end();)
+    {
+        if ((channel && it->channel != channel) || (id >= 0 && it->id != id))
+        {
+            ++it;
+            continue;
+        }
+
+        it->process->disconnect(this);
+        it->process->kill();
+        it->process->waitForFinished(1000);
+        it->process->deleteLater();
+        delete it->workDir;
+        it = jobs.erase(it);
+    }
+}
+
+void EncodeWorker::sendFailure(MessageChannel *channel, int id, const QString &error, bool retry)
+{
+    QJsonObject result;
+    result["type"] = "result";
+    result["id"] = id;
+    result["ok"] = false;
+    result["error"] = error;
+    result["retry"] = retry; // Not the segment's fault; try it elsewhere without counting an attempt
+    channel->send(result);
+}
@@ -0,0 +1,59 @@
+#ifndef ENCODEWORKER_H
+#define ENCODEWORKER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QJsonObject>
+#include <QTcpServer>
+
+class QProcess;
+class QTemporaryDir;
+class QHostAddress;
+class FFmpegLog;
+class MessageChannel;
+
+// Headless encode worker: SimpleVideoEditor --worker <port> --token <secret>. A
+// coordinator first proves it knows the token, then sends a source segment
+// together with ConvertDialog settings; the worker builds the ffmpeg command from
+// those settings itself (it never runs arguments taken from the network), reads
+// the segment only as Matroska from a local file, and sends the result back.
+class EncodeWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    EncodeWorker(int maxJobs, const QByteArray &token, QObject *parent = nullptr);
+    ~EncodeWorker();
+
+    bool listen(const QHostAddress &address, quint16 port, QString *error);
+
+private slots:
+    void acceptConnections();
+
+private:
+    struct Job
+    {
+        MessageChannel *channel;
+        int id;
+        QProcess *process;
+        QTemporaryDir *workDir;
+        QString outputFile;
+    };
+
+    void handleMessage(MessageChannel *channel, const QJsonObject &message, const QByteArray &payload);
+    bool authenticate(MessageChannel *channel, const QJsonObject &message);
+    void startJob(MessageChannel *channel, const QJsonObject &message, const QByteArray &payload);
+    void finishJob(QProcess *process, int exitCode);
+    void stopJobs(MessageChannel *channel, int id = -1);
+    static void sendFailure(MessageChannel *channel, int id, const QString &error, bool retry);
+
+    QTcpServer server;
+    int maxJobs;
+    QByteArray token;
+    QHash<MessageChannel *, QByteArray> challenges; // Coordinators that haven't authenticated yet
+    QHash<QProcess *, Job> jobs;
+    FFmpegLog *log;
+};
+
+#endif // ENCODEWORKER_H
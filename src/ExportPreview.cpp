@@ -0,0 +1,183 @@
+#include "ExportPreview.h"
+#include "FFmpegArguments.h"
+#include "FFmpegLog.h"
+#include <QProcess>
+#include <QMediaPlayer>
+#include <QMessageBox>
+
+ExportPreview::ExportPreview(QMediaPlayer *player, FFmpegLog *log, QObject *parent)
+    : QObject(parent), player(player), log(log), process(nullptr), pendingDir(nullptr), workDir(nullptr),
+      playhead(0), savedPosition(0)
+{
+}
+
+ExportPreview::~ExportPreview()
+{
+    cancel();
+    delete workDir;
+}
+
+void ExportPreview::setPlayhead(double seconds)
+{
+    playhead = seconds;
+}
+
+void ExportPreview::start(const QString &extension, ArgumentBuilder buildArguments)
+{
+    cancel();
+
+    // Each preview gets a fresh directory; the previous one may still be open in the player
+    pendingDir = new QTemporaryDir();
+    QString outputFile = pendingDir->path() + "/preview." + extension;
+
+    // A little before the playhead too, so a cut or fade right at it is visible
+    double start = qMax(0.0, playhead - 1.0);
+    QStringList args = FFmpegArguments::withFastestPreset(
+        FFmpegArguments::withInputWindow(buildArguments(outputFile), start, windowSeconds));
+
+    process = new QProcess(this);
+    log->attach(process, "Preview");
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, outputFile](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                QString error = exitCode == 0 ? QString() : log->lastError(process);
+                process->deleteLater();
+                process = nullptr;
+
+                if (exitCode != 0)
+                {
+                    delete pendingDir;
+                    pendingDir = nullptr;
+                    emit failed(error.isEmpty() ? "Preview encode failed" : error);
+                    return;
+                }
+
+                if (savedSource.isEmpty())
+                {
+                    savedSource = player->source();
+                    savedPosition = player->position();
+                }
+
+                // Switch sources before the old directory goes away
+                player->setSource(QUrl::fromLocalFile(outputFile));
+                player->play();
+                delete workDir;
+                workDir = pendingDir;
+                pendingDir = nullptr;
+
+                emit ready();
+            });
+
+    // finished is never emitted when ffmpeg can't be started at all. The failure is reported
+    // from the event loop, since listeners open message boxes and start() is still on the stack
+    connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error)
+            {
+                if (error != QProcess::FailedToStart)
+                    return;
+                QString message = "Could not start ffmpeg: " + process->errorString();
+                process->deleteLater();
+                process = nullptr;
+                delete pendingDir;
+                pendingDir = nullptr;
+                QMetaObject::invokeMethod(this, [this, message]()
+                                          { emit failed(message); }, Qt::QueuedConnection);
+            });
+
+    process->start("ffmpeg", FFmpegLog::loggingArguments() + args);
+}
+
+void ExportPreview::cancel()
+{
+    if (!process)
+        return;
+
+    process->disconnect(this);
+    process->kill();
+    process->waitForFinished(1000);
+    process->deleteLater();
+    process = nullptr;
+
+    delete pendingDir;
+    pendingDir = nullptr;
+}
+
+bool ExportPreview::isRunning() const
+{
+    return process != nullptr;
+}
+
+void ExportPreview::restore()
+{
+    cancel();
+    if (savedSource.isEmpty())
+        return;
+
+    player->stop();
+    player->setSource(savedSource);
+
+    // Seeking only sticks once the media has loaded
+    qint64 position = savedPosition;
+    QMetaObject::Connection *connection = new QMetaObject::Connection;
+    *connection = connect(player, &QMediaPlayer::mediaStatusChanged, this,
+                          [this, position, connection](QMediaPlayer::MediaStatus status)
+                          {
+                              if (status == QMediaPlayer::LoadingMedia)
+                                  return;
+                              if (status == QMediaPlayer::LoadedMedia)
+                                  player->setPosition(position);
+                              disconnect(*connection);
+                              delete connection;
+                          });
+
+    savedSource.clear();
+    delete workDir;
+    workDir = nullptr;
+}
+
+ExportPreviewButton::ExportPreviewButton(QWidget *parent)
+    : QPushButton("Preview Result", parent), preview(nullptr), extension("mp4"), available(true)
+{
+    setVisible(false);
+    connect(this, &QPushButton::clicked, this, &ExportPreviewButton::run);
+}
+
+void ExportPreviewButton::setPreview(ExportPreview *newPreview, ExportPreview::ArgumentBuilder builder)
+{
+    preview = newPreview;
+    buildArguments = builder;
+    setVisible(preview != nullptr);
+    if (!preview)
+        return;
+
+    connect(preview, &ExportPreview::ready, this, &ExportPreviewButton::reset);
+    connect(preview, &ExportPreview::failed, this, [this](const QString &error)
+            {
+        reset();
+        QMessageBox::warning(window(), "Preview Failed", error); });
+}
+
+void ExportPreviewButton::setExtension(const QString &newExtension)
+{
+    extension = newExtension;
+}
+
+void ExportPreviewButton::setAvailable(bool newAvailable)
+{
+    available = newAvailable;
+    if (!preview || !preview->isRunning())
+        setEnabled(available);
+}
+
+void ExportPreviewButton::run()
+{
+    setEnabled(false);
+    setText("Encoding Preview...");
+    preview->start(extension, buildArguments);
+}
+
+void ExportPreviewButton::reset()
+{
+    setText("Preview Result");
+    setEnabled(available);
+}
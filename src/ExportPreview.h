@@ -0,0 +1,84 @@
+#ifndef EXPORTPREVIEW_H
+#define EXPORTPREVIEW_H
+
+#include <QObject>
+#include <QPushButton>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QTemporaryDir>
+#include <functional>
+
+class QProcess;
+class QMediaPlayer;
+class FFmpegLog;
+
+// Encodes a few seconds around the playhead with a dialog's exact settings at the
+// fastest preset and plays the result in the main player, so wrong settings show
+// up before the full export instead of after it.
+class ExportPreview : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Builds the full ffmpeg argument list for a given output file
+    typedef std::function<QStringList(const QString &outputFile)> ArgumentBuilder;
+
+    ExportPreview(QMediaPlayer *player, FFmpegLog *log, QObject *parent = nullptr);
+    ~ExportPreview();
+
+    // Position the preview window is centred on
+    void setPlayhead(double seconds);
+
+    void start(const QString &extension, ArgumentBuilder buildArguments);
+    void cancel();
+    bool isRunning() const;
+
+    // Puts the player back on the source it showed before the first preview
+    void restore();
+
+signals:
+    void ready();
+    void failed(const QString &error);
+
+private:
+    static const int windowSeconds = 4;
+
+    QMediaPlayer *player;
+    FFmpegLog *log;
+    QProcess *process;
+    QTemporaryDir *pendingDir; // Being written by the running encode
+    QTemporaryDir *workDir;    // Holds the preview the player is showing
+    double playhead;
+
+    QUrl savedSource; // Empty while the player shows the user's own video
+    qint64 savedPosition;
+};
+
+// The export dialogs' "Preview Result" button: encodes a few seconds at the playhead
+// with the dialog's current settings and plays them in the main window.
+class ExportPreviewButton : public QPushButton
+{
+    Q_OBJECT
+
+public:
+    explicit ExportPreviewButton(QWidget *parent = nullptr);
+
+    // Hidden until a preview is set
+    void setPreview(ExportPreview *preview, ExportPreview::ArgumentBuilder buildArguments);
+    void setExtension(const QString &extension);
+
+    // False for settings whose output doesn't play back as one file
+    void setAvailable(bool available);
+
+private:
+    void run();
+    void reset();
+
+    ExportPreview *preview;
+    ExportPreview::ArgumentBuilder buildArguments;
+    QString extension;
+    bool available;
+};
+
+#endif // EXPORTPREVIEW_H
@@ -0,0 +1,109 @@
+#include "FFmpegArguments.h"
+
+namespace FFmpegArguments
+{
+    QStringList withInputWindow(const QStringList &args, double start, double length)
+    {
+        QStringList result = args;
+        int inputIndex = result.indexOf("-i");
+        if (inputIndex < 0)
+            return result;
+
+        // As input options these seek before decoding instead of decoding and discarding
+        QStringList window;
+        window << "-ss" << QString::number(start, 'f', 3)
+               << "-t" << QString::number(length, 'f', 3);
+        for (int i = window.size() - 1; i >= 0; --i)
+            result.insert(inputIndex, window[i]);
+
+        return result;
+    }
+
+    QStringList withInputStart(const QStringList &args, double start)
+    {
+        QStringList result = args;
+        int inputIndex = result.indexOf("-i");
+        if (inputIndex < 0 || start <= 0)
+            return result;
+
+        result.insert(inputIndex, QString::number(start, 'f', 3));
+        result.insert(inputIndex, "-ss");
+        return result;
+    }
+
+    QStringList withOutputFile(const QStringList &args, const QString &outputFile)
+    {
+        QStringList result = args;
+        if (!result.isEmpty())
+            result.last() = outputFile;
+        return result;
+    }
+
+    QStringList withOption(const QStringList &args, const QString &option, const QString &value)
+    {
+        QStringList result = args;
+        int index = result.indexOf(option);
+        if (index >= 0 && index + 1 < result.size() - 1)
+        {
+            result[index + 1] = value;
+            return result;
+        }
+
+        if (result.isEmpty())
+            return result;
+        result.insert(result.size() - 1, value);
+        result.insert(result.size() - 2, option);
+        return result;
+    }
+
+    QStringList withFastestPreset(const QStringList &args)
+    {
+        QString encoder = optionValue(args, "-c:v");
+        if (encoder.isEmpty())
+            encoder = optionValue(args, "-c");
+        if (encoder == "copy")
+            return args;
+
+        QStringList preset;
+        if (encoder.isEmpty() || encoder == "libx264" || encoder == "libx265")
+            preset << "-preset" << "ultrafast";
+        else if (encoder.startsWith("libvpx"))
+            preset << "-deadline" << "realtime" << "-cpu-used" << "8";
+        else if (encoder.endsWith("_nvenc"))
+            preset << "-preset" << "p1";
+        else if (encoder.endsWith("_qsv"))
+            preset << "-preset" << "veryfast";
+
+        // A preset chosen by the dialog would otherwise win
+        QStringList result = args;
+        for (int i = 0; i < preset.size(); i += 2)
+        {
+            int index = result.indexOf(preset[i]);
+            if (index >= 0 && index + 1 < result.size())
+            {
+                result.removeAt(index + 1);
+                result.removeAt(index);
+            }
+        }
+
+        // Output options go right before the output file
+        for (const QString &option : preset)
+            result.insert(result.size() - 1, option);
+        return result;
+    }
+
+    QString optionValue(const QStringList &args, const QString &option)
+    {
+        int index = args.indexOf(option);
+        if (index < 0 || index + 1 >= args.size())
+            return QString();
+        return args[index + 1];
+    }
+
+    QString filterPath(const QString &path)
+    {
+        // Inside a filter option the drive colon of a Windows path would end the value
+        QString escaped = QString(path).replace('\\', '/').replace(":", "\\:");
+        return "'" + escaped + "'";
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef FFMPEGARGUMENTS_H
+#define FFMPEGARGUMENTS_H
+
+#include <QString>
+#include <QStringList>
+
+// Helpers for adapting the argument lists the dialogs build, so derived jobs
+// (samples, previews, segments) use exactly the same settings as the export.
+namespace FFmpegArguments
+{
+    // Seeks the first input to start and reads only length seconds of it
+    QStringList withInputWindow(const QStringList &args, double start, double length);
+
+    // Seeks the first input to start and reads to the end
+    QStringList withInputStart(const QStringList &args, double start);
+
+    // Replaces the output file (the last argument)
+    QStringList withOutputFile(const QStringList &args, const QString &outputFile);
+
+    // Sets an output option, replacing its value if present, otherwise adding it before the output file
+    QStringList withOption(const QStringList &args, const QString &option, const QString &value);
+
+    // Swaps in the encoder's fastest preset, for previews where latency matters more than size.
+    // Stream copies are left alone; without an explicit encoder the muxer default (libx264) is assumed
+    QStringList withFastestPreset(const QStringList &args);
+
+    // Value following an option such as "-c:v", or an empty string
+    QString optionValue(const QStringList &args, const QString &option);
+
+    // A path quoted for use inside a filter option, e.g. ssim=stats_file=<path>
+    QString filterPath(const QString &path);
+}
+
+#endif // FFMPEGARGUMENTS_H
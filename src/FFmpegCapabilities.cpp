@@ -0,0 +1,341 @@
+#include "FFmpegCapabilities.h"
+#include <QProcess>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+
+namespace
+{
+    const int cacheVersion = 4; // 2: bitstream filters, 3: options, 4: scale options
+
+    QJsonArray toJsonArray(const QSet<QString> &set)
+    {
+        QStringList list(set.begin(), set.end());
+        list.sort();
+        return QJsonArray::fromStringList(list);
+    }
+
+    QSet<QString> fromJsonArray(const QJsonValue &value)
+    {
+        QSet<QString> set;
+        for (const QJsonValue &item : value.toArray())
+            set.insert(item.toString());
+        return set;
+    }
+}
+
+FFmpegCapabilities &FFmpegCapabilities::instance()
+{
+    static FFmpegCapabilities capabilities;
+    return capabilities;
+}
+
+FFmpegCapabilities::FFmpegCapabilities(QObject *parent)
+    : QObject(parent), probing(false), probed(false)
+{
+}
+
+void FFmpegCapabilities::probe()
+{
+    if (probing || probed)
+        return;
+
+    ffmpegPath = QStandardPaths::findExecutable("ffmpeg");
+    if (ffmpegPath.isEmpty())
+    {
+        // Nothing to probe; leave the optimistic defaults in place
+        return;
+    }
+    ffmpegModified = QFileInfo(ffmpegPath).lastModified();
+
+    if (loadCache())
+    {
+        probed = true;
+        emit ready();
+        return;
+    }
+
+    probing = true;
+    encoders.clear();
+    muxers.clear();
+    filters.clear();
+    bitstreamFilters.clear();
+    options.clear();
+    filterOptions.clear();
+    brokenEncoders.clear();
+
+    pendingListings = QStringList() << "-encoders" << "-muxers" << "-filters" << "-bsfs" << "-h long"
+                                    << "-h filter=scale";
+    runListing(pendingListings.takeFirst());
+}
+
+bool FFmpegCapabilities::isReady() const
+{
+    return probed;
+}
+
+bool FFmpegCapabilities::hasEncoder(const QString &name) const
+{
+    if (!probed)
+        return true;
+    return encoders.contains(name) && !brokenEncoders.contains(name);
+}
+
+bool FFmpegCapabilities::hasMuxer(const QString &name) const
+{
+    return !probed || muxers.contains(name);
+}
+
+bool FFmpegCapabilities::hasFilter(const QString &name) const
+{
+    return !probed || filters.contains(name);
+}
+
+bool FFmpegCapabilities::hasBitstreamFilter(const QString &name) const
+{
+    return !probed || bitstreamFilters.contains(name);
+}
+
+bool FFmpegCapabilities::hasOption(const QString &name) const
+{
+    return probed && options.contains(name);
+}
+
+bool FFmpegCapabilities::hasFilterOption(const QString &filter, const QString &option) const
+{
+    return probed && filterOptions.contains(filter + ":" + option);
+}
+
+QStringList FFmpegCapabilities::encodersFor(const QString &codec) const
+{
+    QStringList available;
+    for (const QString &name : candidateEncoders(codec))
+    {
+        // Before the probe completes only offer the software encoders we always used
+        if (!probed && (isHardwareEncoder(name) || isOptionalEncoder(name)))
+            continue;
+        if (hasEncoder(name))
+            available << name;
+    }
+    return available;
+}
+
+QString FFmpegCapabilities::bestEncoder(const QString &codec) const
+{
+    QStringList available = encodersFor(codec);
+    return available.isEmpty() ? QString() : available.first();
+}
+
+QStringList FFmpegCapabilities::candidateEncoders(const QString &codec)
+{
+    // Ordered fastest first. Hardware encoders are only kept if a test encode succeeds.
+    if (codec == "h264")
+        return {"h264_nvenc", "h264_qsv", "h264_videotoolbox", "h264_amf", "libx264", "libopenh264"};
+    if (codec == "hevc")
+        return {"hevc_nvenc", "hevc_qsv", "hevc_videotoolbox", "hevc_amf", "libx265"};
+    if (codec == "vp9")
+        return {"vp9_qsv", "libvpx-vp9"};
+    if (codec == "mjpeg")
+        return {"mjpeg_qsv", "mjpeg"};
+    if (codec == "gif")
+        return {"gif"};
+    if (codec == "aac")
+        return {"aac_at", "libfdk_aac", "aac"};
+    if (codec == "mp3")
+        return {"libmp3lame", "libshine"};
+    if (codec == "opus")
+        return {"libopus"};
+    if (codec == "flac")
+        return {"flac"};
+    return {codec};
+}
+
+bool FFmpegCapabilities::isHardwareEncoder(const QString &name)
+{
+    static const QStringList suffixes = {"_nvenc", "_qsv", "_videotoolbox", "_amf", "_vaapi", "_mf"};
+    for (const QString &suffix : suffixes)
+    {
+        if (name.endsWith(suffix))
+            return true;
+    }
+    return false;
+}
+
+bool FFmpegCapabilities::isOptionalEncoder(const QString &name)
+{
+    // Platform-only or non-default builds; assuming them would break jobs everywhere else
+    static const QStringList optional = {"aac_at", "libfdk_aac", "libopenh264", "libshine"};
+    return optional.contains(name) || name.endsWith("_at");
+}
+
+QString FFmpegCapabilities::cacheFilePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/ffmpeg-capabilities.json";
+}
+
+bool FFmpegCapabilities::loadCache()
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+    // Any change to the binary (upgrade, different install) invalidates the cache
+    if (root["version"].toInt() != cacheVersion ||
+        root["path"].toString() != ffmpegPath ||
+        root["modified"].toVariant().toLongLong() != ffmpegModified.toMSecsSinceEpoch())
+        return false;
+
+    encoders = fromJsonArray(root["encoders"]);
+    muxers = fromJsonArray(root["muxers"]);
+    filters = fromJsonArray(root["filters"]);
+    bitstreamFilters = fromJsonArray(root["bitstreamFilters"]);
+    options = fromJsonArray(root["options"]);
+    filterOptions = fromJsonArray(root["filterOptions"]);
+    brokenEncoders = fromJsonArray(root["brokenEncoders"]);
+    return !encoders.isEmpty();
+}
+
+void FFmpegCapabilities::saveCache() const
+{
+    QFileInfo cacheInfo(cacheFilePath());
+    QDir().mkpath(cacheInfo.absolutePath());
+
+    QJsonObject root;
+    root["version"] = cacheVersion;
+    root["path"] = ffmpegPath;
+    root["modified"] = ffmpegModified.toMSecsSinceEpoch();
+    root["encoders"] = toJsonArray(encoders);
+    root["muxers"] = toJsonArray(muxers);
+    root["filters"] = toJsonArray(filters);
+    root["bitstreamFilters"] = toJsonArray(bitstreamFilters);
+    root["options"] = toJsonArray(options);
+    root["filterOptions"] = toJsonArray(filterOptions);
+    root["brokenEncoders"] = toJsonArray(brokenEncoders);
+
+    QFile file(cacheInfo.absoluteFilePath());
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(QJsonDocument(root).toJson());
+}
+
+void FFmpegCapabilities::runListing(const QString &option)
+{
+    QProcess *ffmpeg = new QProcess(this);
+
+    connect(ffmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            [this, ffmpeg, option](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                QString output = QString::fromUtf8(ffmpeg->readAllStandardOutput());
+                ffmpeg->deleteLater();
+
+                // Each listing starts with a legend ("V..... = Video"), which the
+                // patterns below reject because the legend has no real name column
+                static const QRegularExpression encoderLine("^\\s*[VASFXBD.]{6}\\s+([^\\s=]\\S*)");
+                static const QRegularExpression muxerLine("^\\s*[Dd]?E\\s+([^\\s=]\\S*)");
+                static const QRegularExpression filterLine("^\\s*[TSC.|]{2,3}\\s+(\\S+)\\s+\\S*->\\S*");
+                static const QRegularExpression bsfLine("^([a-z0-9_]+)\\s*$"); // Bare names after a heading
+                static const QRegularExpression optionLine("^-([A-Za-z0-9_]+)[\\s\\[]");
+                static const QRegularExpression filterOptionLine("^\\s+([a-z0-9_]+)\\s+<"); // "  threads  <int>  ..FV"
+
+                // "-h filter=scale" lists that filter's options; they are stored as "scale:threads"
+                bool filterHelp = option.startsWith("-h filter=");
+                QString prefix = filterHelp ? option.section('=', 1) + ":" : QString();
+
+                const QRegularExpression &pattern = option == "-encoders" ? encoderLine
+                                                    : option == "-muxers" ? muxerLine
+                                                    : option == "-filters" ? filterLine
+                                                    : option == "-bsfs"    ? bsfLine
+                                                    : filterHelp           ? filterOptionLine
+                                                                           : optionLine;
+                QSet<QString> &target = option == "-encoders" ? encoders
+                                        : option == "-muxers" ? muxers
+                                        : option == "-filters" ? filters
+                                        : option == "-bsfs"    ? bitstreamFilters
+                                        : filterHelp           ? filterOptions
+                                                               : options;
+
+                for (const QString &line : output.split('\n'))
+                {
+                    QRegularExpressionMatch match = pattern.match(line);
+                    if (!match.hasMatch())
+                        continue;
+
+                    // Muxers may share an entry, e.g. "matroska,webm"
+                    for (const QString &name : match.captured(1).split(','))
+                        target.insert(prefix + name);
+                }
+
+                if (!pendingListings.isEmpty())
+                {
+                    runListing(pendingListings.takeFirst());
+                    return;
+                }
+
+                // Hardware encoders are listed whenever ffmpeg was built with them,
+                // whether or not this machine has the device, so try each one
+                pendingHardwareChecks.clear();
+                for (const QString &name : encoders)
+                {
+                    if (isHardwareEncoder(name))
+                        pendingHardwareChecks << name;
+                }
+                verifyNextHardwareEncoder();
+            });
+
+    connect(ffmpeg, &QProcess::errorOccurred, [this, ffmpeg](QProcess::ProcessError error)
+            {
+                if (error != QProcess::FailedToStart)
+                    return;
+                // Give up quietly; the optimistic defaults keep every option available
+                probing = false;
+                pendingListings.clear();
+                ffmpeg->deleteLater();
+            });
+
+    ffmpeg->start(ffmpegPath, QStringList() << "-hide_banner" << option.split(' '));
+}
+
+void FFmpegCapabilities::verifyNextHardwareEncoder()
+{
+    if (pendingHardwareChecks.isEmpty())
+    {
+        finishProbe();
+        return;
+    }
+
+    QString encoder = pendingHardwareChecks.takeFirst();
+    QProcess *ffmpeg = new QProcess(this);
+
+    connect(ffmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            [this, ffmpeg, encoder](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+                    brokenEncoders.insert(encoder);
+                ffmpeg->deleteLater();
+                verifyNextHardwareEncoder();
+            });
+
+    // Encode a single synthetic frame; this fails fast when no device is present
+    QStringList args;
+    args << "-hide_banner" << "-v" << "error"
+         << "-f" << "lavfi" << "-i" << "color=size=256x256:rate=1"
+         << "-frames:v" << "1"
+         << "-c:v" << encoder
+         << "-f" << "null" << "-";
+
+    ffmpeg->start(ffmpegPath, args);
+}
+
+void FFmpegCapabilities::finishProbe()
+{
+    probing = false;
+    probed = true;
+    saveCache();
+    emit ready();
+}
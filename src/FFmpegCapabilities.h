@@ -0,0 +1,76 @@
+#ifndef FFMPEGCAPABILITIES_H
+#define FFMPEGCAPABILITIES_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+// Probes the installed ffmpeg once for its encoders, muxers, filters,
+// bitstream filters and command-line options.
+// Results are cached on disk keyed on the binary's path and modification time,
+// so only the first launch after installing or upgrading ffmpeg pays for the probe.
+class FFmpegCapabilities : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FFmpegCapabilities &instance();
+
+    // Starts the probe in the background (or loads it from the cache)
+    void probe();
+    bool isReady() const;
+
+    // Until the probe has finished these answer optimistically so the UI stays usable
+    bool hasEncoder(const QString &name) const;
+    bool hasMuxer(const QString &name) const;
+    bool hasFilter(const QString &name) const;
+    bool hasBitstreamFilter(const QString &name) const;
+
+    // Command-line options without the dash, e.g. "display_rotation" (ffmpeg 6.0+). Unlike
+    // the above this answers false until the probe confirms, since older builds reject them
+    bool hasOption(const QString &name) const;
+    // Filter options, e.g. ("scale", "threads") from ffmpeg 5.0; also false until probed
+    bool hasFilterOption(const QString &filter, const QString &option) const;
+
+    // Usable encoders for a codec ("h264", "vp9", "opus", ...), fastest first
+    QStringList encodersFor(const QString &codec) const;
+    QString bestEncoder(const QString &codec) const;
+
+signals:
+    void ready();
+
+private:
+    FFmpegCapabilities(QObject *parent = nullptr);
+
+    static QStringList candidateEncoders(const QString &codec);
+    static bool isHardwareEncoder(const QString &name);
+    static bool isOptionalEncoder(const QString &name);
+
+    QString cacheFilePath() const;
+    bool loadCache();
+    void saveCache() const;
+
+    void runListing(const QString &option);
+    void verifyNextHardwareEncoder();
+    void finishProbe();
+
+    QString ffmpegPath;
+    QDateTime ffmpegModified;
+
+    QSet<QString> encoders;
+    QSet<QString> muxers;
+    QSet<QString> filters;
+    QSet<QString> bitstreamFilters;
+    QSet<QString> options;
+    QSet<QString> filterOptions; // "filter:option"
+    QSet<QString> brokenEncoders; // Listed by ffmpeg but failed a test encode
+
+    QStringList pendingListings;
+    QStringList pendingHardwareChecks;
+    bool probing;
+    bool probed;
+};
+
+#endif // FFMPEGCAPABILITIES_H
@@ -0,0 +1,193 @@
+#include "FFmpegLog.h"
+#include <QProcess>
+#include <QRegularExpression>
+
+namespace
+{
+    // Longer lines are truncated; a runaway line must not grow without bound
+    const int maxLineLength = 1024;
+}
+
+FFmpegLog::FFmpegLog(int capacity, QObject *parent)
+    : QObject(parent), ring(qMax(capacity, 1)), head(0), count(0)
+{
+}
+
+void FFmpegLog::attach(QProcess *process, const QString &job)
+{
+    JobState state;
+    state.name = job;
+    jobs.insert(process, state);
+
+    connect(process, &QProcess::readyReadStandardError, this, [this, process]()
+            { readOutput(process); });
+
+    // Attach before connecting other finished handlers so lastError() is complete when they run
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, process](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                readOutput(process);
+                auto it = jobs.find(process);
+                if (it != jobs.end() && !it->partialLine.isEmpty())
+                {
+                    appendLine(*it, it->partialLine);
+                    it->partialLine.clear();
+                }
+            });
+
+    connect(process, &QObject::destroyed, this, [this, process]()
+            { jobs.remove(process); });
+
+    trackStart(process);
+}
+
+void FFmpegLog::trackStart(QProcess *process)
+{
+    connect(process, &QProcess::started, this, [this, process]()
+            { emit processStarted(process->processId(), process->arguments()); });
+}
+
+QVector<FFmpegLog::Entry> FFmpegLog::entries(Level maxLevel) const
+{
+    QVector<Entry> result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const Entry &entry = ring[(head + i) % ring.size()];
+        if (entry.level <= maxLevel)
+            result.append(entry);
+    }
+    return result;
+}
+
+QString FFmpegLog::lastError(const QProcess *process) const
+{
+    return jobs.value(process).lastError;
+}
+
+void FFmpegLog::clear()
+{
+    head = 0;
+    count = 0;
+    emit entryAdded();
+}
+
+QString FFmpegLog::levelName(Level level)
+{
+    switch (level)
+    {
+    case Error:
+        return "Error";
+    case Warning:
+        return "Warning";
+    case Info:
+        return "Info";
+    case Progress:
+        return "Progress";
+    }
+    return QString();
+}
+
+QStringList FFmpegLog::loggingArguments()
+{
+    return QStringList() << "-hide_banner" << "-loglevel" << "level+info";
+}
+
+void FFmpegLog::readOutput(QProcess *process)
+{
+    auto it = jobs.find(process);
+    if (it == jobs.end())
+        return;
+
+    // Only what has arrived since the last read; nothing accumulates in QProcess
+    const QByteArray chunk = process->readAllStandardError();
+    for (char c : chunk)
+    {
+        // ffmpeg rewrites its progress line with '\r'
+        if (c == '\n' || c == '\r')
+        {
+            if (!it->partialLine.isEmpty())
+            {
+                appendLine(*it, it->partialLine);
+                it->partialLine.clear();
+            }
+        }
+        else if (it->partialLine.size() < maxLineLength)
+        {
+            it->partialLine.append(c);
+        }
+    }
+}
+
+void FFmpegLog::appendLine(JobState &state, const QByteArray &rawLine)
+{
+    QString text = QString::fromUtf8(rawLine).trimmed();
+    if (text.isEmpty())
+        return;
+
+    Level level = classify(text);
+    if (level == Error)
+        state.lastError = text;
+
+    Entry entry;
+    entry.time = QDateTime::currentDateTime();
+    entry.level = level;
+    entry.job = state.name;
+    entry.text = text;
+
+    // Progress updates replace each other instead of flooding the buffer
+    if (count > 0)
+    {
+        Entry &last = ring[(head + count - 1) % ring.size()];
+        if (level == Progress && last.level == Progress && last.job == state.name)
+        {
+            last = entry;
+            emit entryAdded();
+            return;
+        }
+    }
+
+    if (count < ring.size())
+    {
+        ring[(head + count) % ring.size()] = entry;
+        ++count;
+    }
+    else
+    {
+        ring[head] = entry;
+        head = (head + 1) % ring.size();
+    }
+
+    emit entryAdded();
+}
+
+FFmpegLog::Level FFmpegLog::classify(QString &text)
+{
+    static const QRegularExpression levelTag("\\[(panic|fatal|error|warning|info|verbose|debug|trace)\\]\\s*");
+
+    Level level = Info;
+    QRegularExpressionMatch match = levelTag.match(text);
+    if (match.hasMatch())
+    {
+        QString tag = match.captured(1);
+        if (tag == "panic" || tag == "fatal" || tag == "error")
+            level = Error;
+        else if (tag == "warning")
+            level = Warning;
+        text.remove(match.capturedStart(), match.capturedLength());
+    }
+    else if (text.contains("error", Qt::CaseInsensitive))
+    {
+        // Untagged output, e.g. from an ffmpeg that ignores the level flag
+        level = Error;
+    }
+    else if (text.contains("warning", Qt::CaseInsensitive))
+    {
+        level = Warning;
+    }
+
+    if (level == Info && (text.startsWith("frame=") || text.startsWith("size=")))
+        level = Progress;
+
+    return level;
+}
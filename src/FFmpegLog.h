@@ -0,0 +1,78 @@
+#ifndef FFMPEGLOG_H
+#define FFMPEGLOG_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QDateTime>
+
+class QProcess;
+
+// Fixed-size ring buffer of ffmpeg output lines. Processes are read incrementally
+// as output arrives, so memory use stays flat however long a job runs.
+class FFmpegLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Ordered from most to least severe
+    enum Level
+    {
+        Error,
+        Warning,
+        Info,
+        Progress
+    };
+
+    struct Entry
+    {
+        QDateTime time;
+        Level level;
+        QString job;
+        QString text;
+    };
+
+    explicit FFmpegLog(int capacity = 2000, QObject *parent = nullptr);
+
+    // Starts capturing a process's stderr under the given job name
+    void attach(QProcess *process, const QString &job);
+
+    // Announces the process through processStarted without capturing its output,
+    // for processes whose stderr is parsed by their owner. attach() includes this.
+    void trackStart(QProcess *process);
+
+    QVector<Entry> entries(Level maxLevel) const;
+    QString lastError(const QProcess *process) const;
+    void clear();
+
+    static QString levelName(Level level);
+
+    // Arguments that make ffmpeg tag each line with its level
+    static QStringList loggingArguments();
+
+signals:
+    void entryAdded();
+    void processStarted(qint64 pid, const QStringList &arguments);
+
+private:
+    struct JobState
+    {
+        QString name;
+        QByteArray partialLine;
+        QString lastError;
+    };
+
+    void readOutput(QProcess *process);
+    void appendLine(JobState &state, const QByteArray &rawLine);
+    static Level classify(QString &text);
+
+    QVector<Entry> ring;
+    int head;  // Index of the oldest entry
+    int count; // Number of valid entries
+    QHash<const QProcess *, JobState> jobs;
+};
+
+#endif // FFMPEGLOG_H
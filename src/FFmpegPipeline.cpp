@@ -0,0 +1,128 @@
+#include "FFmpegPipeline.h"
+#include "FFmpegLog.h"
+#include <QProcess>
+
+FFmpegPipeline::FFmpegPipeline(FFmpegLog *log, const QString &jobName, QObject *parent)
+    : QObject(parent), log(log), jobName(jobName), nextStep(0), completed(0), maxParallel(1)
+{
+}
+
+FFmpegPipeline::~FFmpegPipeline()
+{
+    cancel();
+}
+
+void FFmpegPipeline::addStep(const QStringList &arguments)
+{
+    Step step;
+    step.arguments = arguments;
+    step.barrier = false;
+    steps.append(step);
+}
+
+void FFmpegPipeline::addBarrier()
+{
+    Step step;
+    step.barrier = true;
+    steps.append(step);
+}
+
+void FFmpegPipeline::setMaxParallel(int count)
+{
+    maxParallel = qMax(1, count);
+}
+
+void FFmpegPipeline::start()
+{
+    nextStep = 0;
+    completed = 0;
+    startReadySteps();
+}
+
+void FFmpegPipeline::cancel()
+{
+    for (QProcess *process : running)
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+    running.clear();
+    nextStep = steps.size();
+}
+
+bool FFmpegPipeline::isRunning() const
+{
+    return !running.isEmpty() || nextStep < steps.size();
+}
+
+int FFmpegPipeline::stepCount() const
+{
+    int count = 0;
+    for (const Step &step : steps)
+        count += step.barrier ? 0 : 1;
+    return count;
+}
+
+void FFmpegPipeline::startReadySteps()
+{
+    while (nextStep < steps.size() && running.size() < maxParallel)
+    {
+        const Step &step = steps[nextStep];
+        if (step.barrier)
+        {
+            // Hold until everything before the barrier is done
+            if (!running.isEmpty())
+                return;
+            ++nextStep;
+            continue;
+        }
+
+        QProcess *process = new QProcess(this);
+        log->attach(process, jobName);
+        running.append(process);
+        ++nextStep;
+
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, process](int exitCode, QProcess::ExitStatus exitStatus)
+                {
+                    running.removeOne(process);
+                    process->deleteLater();
+
+                    if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+                    {
+                        QString error = log->lastError(process);
+                        cancel();
+                        emit finished(false, error.isEmpty() ? "FFMPEG step failed" : error);
+                        return;
+                    }
+
+                    ++completed;
+                    emit progress(completed, stepCount());
+
+                    if (running.isEmpty() && nextStep >= steps.size())
+                    {
+                        emit finished(true, QString());
+                        return;
+                    }
+                    startReadySteps();
+                });
+
+        // A missing ffmpeg never emits finished; queued so the failure lands after start() returns
+        connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error)
+                {
+                    if (error != QProcess::FailedToStart || !running.contains(process))
+                        return;
+                    running.removeOne(process);
+                    process->deleteLater();
+                    cancel();
+                    emit finished(false, "Could not start ffmpeg: " + process->errorString());
+                }, Qt::QueuedConnection);
+
+        process->start("ffmpeg", FFmpegLog::loggingArguments() + step.arguments);
+    }
+
+    // Trailing barriers (or an empty pipeline) leave nothing to wait for
+    if (running.isEmpty() && nextStep >= steps.size())
+        emit finished(true, QString());
+}
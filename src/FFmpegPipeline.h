@@ -0,0 +1,54 @@
+#ifndef FFMPEGPIPELINE_H
+#define FFMPEGPIPELINE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+class QProcess;
+class FFmpegLog;
+
+// Runs a list of ffmpeg invocations. Steps start in order, up to maxParallel at
+// a time; a barrier waits for everything before it (e.g. parts before a concat).
+// The first failure cancels the rest.
+class FFmpegPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    FFmpegPipeline(FFmpegLog *log, const QString &jobName, QObject *parent = nullptr);
+    ~FFmpegPipeline();
+
+    void addStep(const QStringList &arguments);
+    void addBarrier();
+    void setMaxParallel(int count);
+
+    void start();
+    void cancel();
+    bool isRunning() const;
+    int stepCount() const;
+
+signals:
+    void progress(int completedSteps, int totalSteps);
+    void finished(bool success, const QString &error);
+
+private:
+    struct Step
+    {
+        QStringList arguments; // Empty for a barrier
+        bool barrier;
+    };
+
+    void startReadySteps();
+
+    FFmpegLog *log;
+    QString jobName;
+    QList<Step> steps;
+    int nextStep;
+    int completed;
+    int maxParallel;
+    QList<QProcess *> running;
+};
+
+#endif // FFMPEGPIPELINE_H
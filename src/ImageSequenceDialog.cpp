@@ -0,0 +1,137 @@
+#include "ImageSequenceDialog.h"
+#include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QImageWriter>
+#include <QThread>
+#include <utility>
+
+ImageSequenceDialog::ImageSequenceDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent)
+    : QDialog(parent), videoFile(videoFile), info(info)
+{
+    setWindowTitle("Export Image Sequence");
+
+    // ffmpeg applies the display matrix while decoding, so frames come out upright
+    if (qAbs(this->info.rotation) % 180 == 90)
+        std::swap(this->info.width, this->info.height);
+
+    QFormLayout *layout = new QFormLayout(this);
+
+    startTimeInput = new QDoubleSpinBox(this);
+    startTimeInput->setDecimals(2);
+    startTimeInput->setRange(0.0, info.duration);
+    startTimeInput->setSuffix(" sec");
+    layout->addRow("Start Time:", startTimeInput);
+
+    endTimeInput = new QDoubleSpinBox(this);
+    endTimeInput->setDecimals(2);
+    endTimeInput->setRange(0.0, info.duration);
+    endTimeInput->setValue(info.duration);
+    endTimeInput->setSuffix(" sec");
+    layout->addRow("End Time:", endTimeInput);
+
+    strideInput = new QSpinBox(this);
+    strideInput->setRange(1, 10000);
+    strideInput->setPrefix("every ");
+    strideInput->setSuffix(" frame(s)");
+    layout->addRow("Keep:", strideInput);
+
+    scaleCheckbox = new QCheckBox("Scale to width", this);
+    widthInput = new QSpinBox(this);
+    widthInput->setRange(16, qMax(16, this->info.width));
+    widthInput->setValue(qMin(640, qMax(16, this->info.width)));
+    widthInput->setSuffix(" px");
+    widthInput->setEnabled(false);
+    layout->addRow(scaleCheckbox, widthInput);
+
+    // WebP needs the Qt image formats plugin, so only offer what can be written
+    formatCombo = new QComboBox(this);
+    QList<QByteArray> writable = QImageWriter::supportedImageFormats();
+    formatCombo->addItem("PNG (lossless)", "png");
+    formatCombo->addItem("JPEG", "jpg");
+    if (writable.contains("webp"))
+        formatCombo->addItem("WebP", "webp");
+    layout->addRow("Format:", formatCombo);
+
+    qualityInput = new QSpinBox(this);
+    qualityInput->setRange(1, 100);
+    qualityInput->setValue(90);
+    qualityInput->setEnabled(false);
+    layout->addRow("Quality:", qualityInput);
+
+    summaryLabel = new QLabel(this);
+    layout->addRow(summaryLabel);
+
+    connect(startTimeInput, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &ImageSequenceDialog::validateTimes);
+    connect(endTimeInput, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &ImageSequenceDialog::validateTimes);
+    connect(strideInput, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ImageSequenceDialog::updateSummary);
+    connect(widthInput, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ImageSequenceDialog::updateSummary);
+    connect(scaleCheckbox, &QCheckBox::toggled, widthInput, &QSpinBox::setEnabled);
+    connect(scaleCheckbox, &QCheckBox::toggled, this, &ImageSequenceDialog::updateSummary);
+    connect(formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]()
+            {
+        qualityInput->setEnabled(formatCombo->currentData().toString() != "png");
+        updateSummary(); });
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    updateSummary();
+}
+
+ImageSequenceJob ImageSequenceDialog::getJob(const QString &outputDir) const
+{
+    ImageSequenceJob job;
+    job.videoFile = videoFile;
+    job.startSeconds = startTimeInput->value();
+    job.endSeconds = endTimeInput->value();
+    job.stride = strideInput->value();
+    job.frameSize = outputSize();
+    job.format = formatCombo->currentData().toString();
+    job.quality = qualityInput->isEnabled() ? qualityInput->value() : -1;
+    job.outputDir = outputDir;
+    job.expectedFrames = expectedFrames();
+    return job;
+}
+
+QSize ImageSequenceDialog::outputSize() const
+{
+    if (!scaleCheckbox->isChecked() || info.width <= 0)
+        return QSize(info.width, info.height);
+
+    // Even height keeps the aspect ratio within a pixel and suits every writer
+    int width = widthInput->value();
+    int height = qMax(2, qRound(double(info.height) * width / info.width / 2) * 2);
+    return QSize(width, height);
+}
+
+int ImageSequenceDialog::expectedFrames() const
+{
+    double rate = MediaProbe::frameRateValue(info.frameRate);
+    double length = endTimeInput->value() - startTimeInput->value();
+    return rate > 0 ? qMax(1, int(length * rate / strideInput->value())) : 0;
+}
+
+void ImageSequenceDialog::validateTimes()
+{
+    if (startTimeInput->value() >= endTimeInput->value())
+        endTimeInput->setValue(qMin(info.duration, startTimeInput->value() + 0.1));
+    updateSummary();
+}
+
+void ImageSequenceDialog::updateSummary()
+{
+    QSize size = outputSize();
+    int frames = expectedFrames();
+    summaryLabel->setText(QString("About %1 images at %2x%3, written on %4 threads")
+                              .arg(frames > 0 ? QString::number(frames) : QString("?"))
+                              .arg(size.width())
+                              .arg(size.height())
+                              .arg(qMax(1, QThread::idealThreadCount() - 1)));
+}
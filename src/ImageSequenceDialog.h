@@ -0,0 +1,44 @@
+#ifndef IMAGESEQUENCEDIALOG_H
+#define IMAGESEQUENCEDIALOG_H
+
+#include <QDialog>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QString>
+#include "MediaProbe.h"
+#include "ImageSequenceExporter.h"
+
+class ImageSequenceDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ImageSequenceDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent = nullptr);
+
+    ImageSequenceJob getJob(const QString &outputDir) const;
+
+private slots:
+    void validateTimes();
+    void updateSummary();
+
+private:
+    QSize outputSize() const;
+    int expectedFrames() const;
+
+    QString videoFile;
+    MediaInfo info;
+
+    QDoubleSpinBox *startTimeInput;
+    QDoubleSpinBox *endTimeInput;
+    QSpinBox *strideInput;
+    QCheckBox *scaleCheckbox;
+    QSpinBox *widthInput;
+    QComboBox *formatCombo;
+    QSpinBox *qualityInput;
+    QLabel *summaryLabel;
+};
+
+#endif // IMAGESEQUENCEDIALOG_H
@@ -0,0 +1,173 @@
+#include "ImageSequenceExporter.h"
+#include <QProcess>
+#include <QSemaphore>
+#include <QImage>
+#include <QImageWriter>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMetaObject>
+
+ImageSequenceWorker::ImageSequenceWorker()
+    : cancelled(false)
+{
+    // One core stays with the decoder feeding the writers
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+void ImageSequenceWorker::run(const ImageSequenceJob &job)
+{
+    cancelled = false;
+    firstError.clear();
+
+    const int width = job.frameSize.width();
+    const int height = job.frameSize.height();
+    const qint64 frameBytes = qint64(width) * height * 3;
+
+    QStringList filters;
+    if (job.stride > 1)
+        filters << QString("framestep=%1").arg(job.stride);
+    filters << QString("scale=%1:%2").arg(width).arg(height);
+
+    QStringList args;
+    args << "-v" << "error"
+         << "-ss" << QString::number(job.startSeconds, 'f', 3)
+         << "-i" << job.videoFile
+         << "-t" << QString::number(job.endSeconds - job.startSeconds, 'f', 3)
+         << "-an" << "-sn"
+         << "-vf" << filters.join(',')
+         << "-pix_fmt" << "rgb24" // QImage::Format_RGB888
+         << "-f" << "rawvideo" << "-";
+
+    // Owned by this thread and read with blocking calls: nothing is pulled from the
+    // pipe unless a frame slot is free, which is what bounds the queue
+    QProcess process;
+    process.start("ffmpeg", args);
+    if (!process.waitForStarted())
+    {
+        emit finished(false, "Could not start ffmpeg", 0);
+        return;
+    }
+
+    QSemaphore freeSlots(pool.maxThreadCount() * 2);
+    std::atomic<int> written(0);
+    QByteArray extension = job.format.toLatin1();
+    QDir outputDir(job.outputDir);
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+
+    int index = 0;
+    while (!cancelled)
+    {
+        if (process.bytesAvailable() < frameBytes)
+        {
+            if (!process.waitForReadyRead(1000) && process.state() == QProcess::NotRunning)
+                break;
+            continue;
+        }
+
+        // Writers are behind: leave the pipe alone so ffmpeg blocks instead of memory growing
+        while (!cancelled && !freeSlots.tryAcquire(1, 100))
+            continue;
+        if (cancelled)
+            break;
+
+        // The raw bytes are wrapped into an image on the writer thread, not here
+        QByteArray data = process.read(frameBytes);
+        QString path = outputDir.filePath(ImageSequenceExporter::fileName(index++, job.format));
+        pool.start([this, data, path, width, height, extension, &job, &freeSlots, &written]()
+                   {
+            QImage image(reinterpret_cast<const uchar *>(data.constData()), width, height,
+                         width * 3, QImage::Format_RGB888);
+            QImageWriter writer(path, extension);
+            if (job.quality >= 0)
+                writer.setQuality(job.quality);
+            if (writer.write(image))
+                ++written;
+            else
+                writeFailed(path + ": " + writer.errorString());
+            freeSlots.release(); });
+
+        if (progressTimer.elapsed() >= 200)
+        {
+            emit progress(written);
+            progressTimer.restart();
+        }
+    }
+
+    if (cancelled)
+        process.kill();
+    process.waitForFinished(-1);
+    pool.waitForDone();
+
+    QString error;
+    {
+        QMutexLocker locker(&errorMutex);
+        error = firstError;
+    }
+    if (error.isEmpty() && process.exitCode() != 0 && !cancelled)
+        error = QString::fromUtf8(process.readAllStandardError()).trimmed();
+    if (error.isEmpty() && cancelled)
+        error = "Cancelled";
+
+    emit finished(error.isEmpty(), error, written);
+}
+
+void ImageSequenceWorker::writeFailed(const QString &error)
+{
+    // Usually a full disk or a missing image plugin; no point in decoding further
+    QMutexLocker locker(&errorMutex);
+    if (firstError.isEmpty())
+        firstError = error;
+    cancelled = true;
+}
+
+ImageSequenceExporter::ImageSequenceExporter(QObject *parent)
+    : QObject(parent), worker(new ImageSequenceWorker()), expectedFrames(0), running(false)
+{
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+
+    connect(worker, &ImageSequenceWorker::progress, this, [this](int framesWritten)
+            { emit progress(framesWritten, expectedFrames); });
+    connect(worker, &ImageSequenceWorker::finished, this,
+            [this](bool success, const QString &error, int framesWritten)
+            {
+                running = false;
+                emit finished(success, error, framesWritten);
+            });
+
+    thread.start();
+}
+
+ImageSequenceExporter::~ImageSequenceExporter()
+{
+    cancel();
+    thread.quit();
+    thread.wait();
+}
+
+void ImageSequenceExporter::start(const ImageSequenceJob &job)
+{
+    if (running)
+        return;
+
+    running = true;
+    expectedFrames = job.expectedFrames;
+    QMetaObject::invokeMethod(worker, [this, job]()
+                              { worker->run(job); }, Qt::QueuedConnection);
+}
+
+void ImageSequenceExporter::cancel()
+{
+    worker->cancelled = true;
+}
+
+bool ImageSequenceExporter::isRunning() const
+{
+    return running;
+}
+
+QString ImageSequenceExporter::fileName(int index, const QString &format)
+{
+    return QString("frame_%1.%2").arg(index, 6, 10, QChar('0')).arg(format);
+}
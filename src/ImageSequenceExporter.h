@@ -0,0 +1,79 @@
+#ifndef IMAGESEQUENCEEXPORTER_H
+#define IMAGESEQUENCEEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QSize>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <atomic>
+
+// What to extract and how to write it
+struct ImageSequenceJob
+{
+    QString videoFile;
+    double startSeconds = 0;
+    double endSeconds = 0;
+    int stride = 1;       // Keep every Nth decoded frame
+    QSize frameSize;      // Output size; the decoder scales to it
+    QString format;       // "png", "jpg" or "webp"
+    int quality = -1;     // QImageWriter quality, -1 for the format default
+    QString outputDir;
+    int expectedFrames = 0; // For progress only
+};
+
+// Reads raw frames from a single ffmpeg decode and hands each one to a pool of
+// image writers. The number of frames in flight is capped; when the writers fall
+// behind the reader stops draining the pipe and ffmpeg blocks, so memory stays flat.
+class ImageSequenceWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    ImageSequenceWorker();
+
+    std::atomic<bool> cancelled;
+
+public slots:
+    void run(const ImageSequenceJob &job);
+
+signals:
+    void progress(int framesWritten);
+    void finished(bool success, const QString &error, int framesWritten);
+
+private:
+    void writeFailed(const QString &error);
+
+    QThreadPool pool;
+    QMutex errorMutex;
+    QString firstError;
+};
+
+// Extracts image sequences with decoding on one thread and compression on all the others
+class ImageSequenceExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageSequenceExporter(QObject *parent = nullptr);
+    ~ImageSequenceExporter();
+
+    void start(const ImageSequenceJob &job);
+    void cancel();
+    bool isRunning() const;
+
+    static QString fileName(int index, const QString &format);
+
+signals:
+    void progress(int framesWritten, int expectedFrames);
+    void finished(bool success, const QString &error, int framesWritten);
+
+private:
+    QThread thread;
+    ImageSequenceWorker *worker;
+    int expectedFrames;
+    bool running;
+};
+
+#endif // IMAGESEQUENCEEXPORTER_H
@@ -0,0 +1,194 @@
+#include "InputPrefetcher.h"
+#include <QMetaObject>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#endif
+
+namespace
+{
+    const qint64 chunkSize = 1 << 20;     // 1 MiB per tick
+    const qint64 headBytes = 16 << 20;    // Container header plus the first GOPs
+    const qint64 tailBytes = 4 << 20;     // Index at the end (MP4 moov, MKV cues)
+    const qint64 followWindow = 64 << 20; // Kept ahead of an export's reads
+}
+
+PrefetchWorker::PrefetchWorker()
+    : timer(nullptr), throttled(false)
+{
+}
+
+void PrefetchWorker::open(const QString &fileName)
+{
+    if (!openFile(fileName))
+        return;
+
+    qint64 size = file.size();
+    queue(0, qMin(size, headBytes));
+    if (size > headBytes)
+        queue(qMax(headBytes, size - tailBytes), qMin(tailBytes, size - headBytes));
+}
+
+void PrefetchWorker::follow(qint64 pid, const QString &fileName)
+{
+    // Reopening would drop the queued head and tail and every other followed process
+    if ((!file.isOpen() || file.fileName() != fileName) && !openFile(fileName))
+        return;
+
+    // The head is most likely already cached from opening the file
+    followed.insert(pid, 0);
+    if (!timer->isActive())
+        timer->start();
+}
+
+void PrefetchWorker::setThrottled(bool active)
+{
+    throttled = active;
+    if (timer)
+        timer->setInterval(throttled ? 100 : 10);
+}
+
+void PrefetchWorker::stop()
+{
+    if (timer)
+        timer->stop();
+    pending.clear();
+    followed.clear();
+    file.close();
+}
+
+bool PrefetchWorker::openFile(const QString &fileName)
+{
+    // Created here so the timer lives on the worker thread
+    if (!timer)
+    {
+        timer = new QTimer(this);
+        timer->setInterval(throttled ? 100 : 10);
+        connect(timer, &QTimer::timeout, this, &PrefetchWorker::tick);
+        buffer.resize(chunkSize);
+    }
+
+    stop();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+#ifdef Q_OS_UNIX
+    // Only affects readahead on this descriptor, i.e. the prefetch reads themselves
+    posix_fadvise(file.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+void PrefetchWorker::queue(qint64 offset, qint64 length)
+{
+    if (length <= 0)
+        return;
+
+#ifdef Q_OS_UNIX
+    // Starts asynchronous readahead into the shared page cache; network filesystems
+    // may ignore it, which is why every range is also read below
+    posix_fadvise(file.handle(), offset, length, POSIX_FADV_WILLNEED);
+#endif
+
+    for (qint64 chunk = offset; chunk < offset + length; chunk += chunkSize)
+        pending.append(ByteRange(chunk, qMin(chunkSize, offset + length - chunk)));
+
+    if (!timer->isActive())
+        timer->start();
+}
+
+void PrefetchWorker::tick()
+{
+    qint64 slowest = -1;
+    for (auto it = followed.begin(); it != followed.end();)
+    {
+        qint64 consumed = bytesReadBy(it.key());
+        if (consumed < 0)
+        {
+            // Process has exited
+            it = followed.erase(it);
+            continue;
+        }
+
+        // rchar approximates the demuxer position for a single sequential input
+        qint64 target = qMin(consumed + followWindow, file.size());
+        qint64 queuedUpTo = qMax(it.value(), consumed);
+        if (target - queuedUpTo >= chunkSize || (target == file.size() && target > queuedUpTo))
+        {
+            queue(queuedUpTo, target - queuedUpTo);
+            queuedUpTo = target;
+        }
+        it.value() = queuedUpTo;
+        slowest = slowest < 0 ? consumed : qMin(slowest, consumed);
+        ++it;
+    }
+
+    // Chunks every followed process has already read past are no longer worth fetching
+    while (slowest >= 0 && !pending.isEmpty() && pending.first().first + pending.first().second <= slowest)
+        pending.removeFirst();
+
+    if (pending.isEmpty())
+    {
+        if (followed.isEmpty())
+            timer->stop();
+        return;
+    }
+
+    ByteRange range = pending.takeFirst();
+    if (file.seek(range.first))
+        file.read(buffer.data(), range.second);
+}
+
+qint64 PrefetchWorker::bytesReadBy(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    QFile io(QString("/proc/%1/io").arg(pid));
+    if (!io.open(QIODevice::ReadOnly))
+        return -1;
+
+    for (const QByteArray &line : io.readAll().split('\n'))
+    {
+        if (line.startsWith("rchar:"))
+            return line.mid(6).trimmed().toLongLong();
+    }
+    return -1;
+#else
+    // No per-process I/O counters to follow
+    Q_UNUSED(pid);
+    return -1;
+#endif
+}
+
+InputPrefetcher::InputPrefetcher(QObject *parent)
+    : QObject(parent), worker(new PrefetchWorker())
+{
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+    thread.start(QThread::LowPriority);
+}
+
+InputPrefetcher::~InputPrefetcher()
+{
+    QMetaObject::invokeMethod(worker, &PrefetchWorker::stop, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
+
+void InputPrefetcher::prefetch(const QString &fileName)
+{
+    QMetaObject::invokeMethod(worker, [this, fileName]()
+                              { worker->open(fileName); }, Qt::QueuedConnection);
+}
+
+void InputPrefetcher::followProcess(qint64 pid, const QString &fileName)
+{
+    QMetaObject::invokeMethod(worker, [this, pid, fileName]()
+                              { worker->follow(pid, fileName); }, Qt::QueuedConnection);
+}
+
+void InputPrefetcher::setPlaybackActive(bool active)
+{
+    QMetaObject::invokeMethod(worker, [this, active]()
+                              { worker->setThrottled(active); }, Qt::QueuedConnection);
+}
@@ -0,0 +1,73 @@
+#ifndef INPUTPREFETCHER_H
+#define INPUTPREFETCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include <QFile>
+#include <QTimer>
+#include <QThread>
+#include <QByteArray>
+
+// Reads file ranges into the page cache on a worker thread, one chunk per tick
+// so a new request or a throttle change takes effect immediately.
+class PrefetchWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    PrefetchWorker();
+
+public slots:
+    void open(const QString &fileName);
+    void follow(qint64 pid, const QString &fileName);
+    void setThrottled(bool throttled);
+    void stop();
+
+private slots:
+    void tick();
+
+private:
+    typedef QPair<qint64, qint64> ByteRange; // Offset and length
+
+    bool openFile(const QString &fileName);
+    void queue(qint64 offset, qint64 length);
+    static qint64 bytesReadBy(qint64 pid);
+
+    QFile file;
+    QList<ByteRange> pending;
+    QByteArray buffer;
+    QTimer *timer;
+    bool throttled;
+
+    QHash<qint64, qint64> followed; // Followed pid -> end of the furthest range queued for it
+};
+
+// Warms slow storage (spinning disks, network mounts) so the first scrub,
+// frame grab and export after opening a file don't stall on cold reads.
+// Reads are throttled while the player is running so playback is never starved.
+class InputPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputPrefetcher(QObject *parent = nullptr);
+    ~InputPrefetcher();
+
+    // Warms the start and end of the file, where containers keep their index
+    void prefetch(const QString &fileName);
+
+    // Keeps a read-ahead window in front of a running ffmpeg's input reads. Several processes
+    // can be followed at once; each must read the file sequentially from its start
+    void followProcess(qint64 pid, const QString &fileName);
+
+    void setPlaybackActive(bool active);
+
+private:
+    QThread thread;
+    PrefetchWorker *worker;
+};
+
+#endif // INPUTPREFETCHER_H
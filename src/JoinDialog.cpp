@@ -0,0 +1,331 @@
+#include "JoinDialog.h"
+#include "FFmpegCapabilities.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QMap>
+
+JoinDialog::JoinDialog(const QString &firstFile, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Join Clips");
+    setMinimumWidth(500);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(new QLabel("Clips are joined in this order:", this));
+
+    fileList = new QListWidget(this);
+    fileList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    mainLayout->addWidget(fileList);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *addButton = new QPushButton("Add...", this);
+    removeButton = new QPushButton("Remove", this);
+    upButton = new QPushButton("Move Up", this);
+    downButton = new QPushButton("Move Down", this);
+    buttonLayout->addWidget(addButton);
+    buttonLayout->addWidget(removeButton);
+    buttonLayout->addWidget(upButton);
+    buttonLayout->addWidget(downButton);
+    mainLayout->addLayout(buttonLayout);
+
+    summaryLabel = new QLabel(this);
+    summaryLabel->setWordWrap(true);
+    mainLayout->addWidget(summaryLabel);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    okButton = buttonBox->button(QDialogButtonBox::Ok);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    connect(addButton, &QPushButton::clicked, this, &JoinDialog::addFiles);
+    connect(removeButton, &QPushButton::clicked, this, &JoinDialog::removeSelected);
+    connect(upButton, &QPushButton::clicked, [this]()
+            { moveSelected(-1); });
+    connect(downButton, &QPushButton::clicked, [this]()
+            { moveSelected(1); });
+
+    if (!firstFile.isEmpty())
+        addFile(firstFile);
+    updateSummary();
+}
+
+QStringList JoinDialog::getInputFiles() const
+{
+    QStringList files;
+    for (int i = 0; i < fileList->count(); ++i)
+        files << fileList->item(i)->data(Qt::UserRole).toString();
+    return files;
+}
+
+QString JoinDialog::compatibilityKey(const MediaInfo &info)
+{
+    // Everything the concat demuxer needs to be identical across files
+    QStringList parts;
+    parts << info.videoCodec << info.videoProfile
+          << QString("%1x%2").arg(info.width).arg(info.height)
+          << info.pixelFormat
+          << QString::number(MediaProbe::frameRateValue(info.frameRate), 'f', 3);
+    if (info.hasAudio)
+        parts << info.audioCodec << QString::number(info.sampleRate) << QString::number(info.channels);
+    else
+        parts << "no audio";
+    return parts.join(' ');
+}
+
+QString JoinDialog::referenceKey() const
+{
+    // The most common parameters win, so the fewest clips are re-encoded;
+    // ties go to whichever comes first
+    QMap<QString, int> counts;
+    QString best;
+    for (const QString &file : getInputFiles())
+    {
+        QString key = compatibilityKey(probed.value(file));
+        int count = ++counts[key];
+        if (best.isEmpty() || count > counts.value(best))
+            best = key;
+    }
+    return best;
+}
+
+bool JoinDialog::needsReencode() const
+{
+    QString reference = referenceKey();
+    for (const QString &file : getInputFiles())
+    {
+        if (compatibilityKey(probed.value(file)) != reference)
+            return true;
+    }
+    return false;
+}
+
+void JoinDialog::addFiles()
+{
+    QStringList files = QFileDialog::getOpenFileNames(this, "Add Clips", "",
+                                                      "Video Files (*.mp4 *.avi *.mkv *.mov *.wmv *.mts *.ts)");
+    for (const QString &file : files)
+        addFile(file);
+    updateSummary();
+}
+
+void JoinDialog::addFile(const QString &fileName)
+{
+    // Headers only, so even dozens of clips probe quickly
+    if (!probed.contains(fileName))
+        probed.insert(fileName, MediaProbe::probe(fileName));
+
+    const MediaInfo &info = probed[fileName];
+    QString details = info.hasVideo
+                          ? QString("%1x%2 %3 %4 fps")
+                                .arg(info.width)
+                                .arg(info.height)
+                                .arg(info.videoCodec)
+                                .arg(MediaProbe::frameRateValue(info.frameRate), 0, 'f', 2)
+                          : QString("no video stream");
+    if (info.hasVideo)
+        details += info.hasAudio ? ", " + info.audioCodec : ", no audio";
+
+    QListWidgetItem *item = new QListWidgetItem(QFileInfo(fileName).fileName() + "  (" + details + ")");
+    item->setData(Qt::UserRole, fileName);
+    item->setToolTip(fileName);
+    fileList->addItem(item);
+}
+
+void JoinDialog::removeSelected()
+{
+    qDeleteAll(fileList->selectedItems());
+    updateSummary();
+}
+
+void JoinDialog::moveSelected(int offset)
+{
+    int row = fileList->currentRow();
+    int target = row + offset;
+    if (row < 0 || target < 0 || target >= fileList->count())
+        return;
+
+    QListWidgetItem *item = fileList->takeItem(row);
+    fileList->insertItem(target, item);
+    fileList->setCurrentRow(target);
+    updateSummary();
+}
+
+void JoinDialog::updateSummary()
+{
+    QStringList files = getInputFiles();
+    bool hasInvalid = false;
+    for (const QString &file : files)
+        hasInvalid |= !probed.value(file).hasVideo;
+
+    okButton->setEnabled(files.size() >= 2 && !hasInvalid);
+    if (files.size() < 2)
+    {
+        summaryLabel->setText("Add at least two clips.");
+        return;
+    }
+    if (hasInvalid)
+    {
+        summaryLabel->setText("Some files have no readable video stream; remove them to continue.");
+        return;
+    }
+
+    // Mark the clips that will be re-encoded
+    QString reference = referenceKey();
+    int mismatched = 0;
+    for (int i = 0; i < fileList->count(); ++i)
+    {
+        QListWidgetItem *item = fileList->item(i);
+        bool matches = compatibilityKey(probed.value(item->data(Qt::UserRole).toString())) == reference;
+        item->setForeground(matches ? palette().text() : QBrush(Qt::darkYellow));
+        mismatched += matches ? 0 : 1;
+    }
+
+    if (mismatched == 0)
+        summaryLabel->setText(QString("All %1 clips match (%2); they are joined by stream copy without re-encoding.")
+                                  .arg(files.size())
+                                  .arg(reference));
+    else
+        summaryLabel->setText(QString("%1 of %2 clips (highlighted) differ and will be re-encoded to match the others (%3).")
+                                  .arg(mismatched)
+                                  .arg(files.size())
+                                  .arg(reference));
+}
+
+QStringList JoinDialog::normalizeArguments(const MediaInfo &info, const MediaInfo &reference,
+                                           const QString &inputFile, const QString &outputFile) const
+{
+    const FFmpegCapabilities &capabilities = FFmpegCapabilities::instance();
+
+    QString videoEncoder = reference.videoCodec == "h264"   ? "libx264"
+                           : reference.videoCodec == "hevc" ? "libx265"
+                                                            : capabilities.bestEncoder(reference.videoCodec);
+    if (videoEncoder.isEmpty())
+        videoEncoder = reference.videoCodec; // Most native encoders share the codec's name
+
+    QStringList args;
+    args << "-y" << "-i" << inputFile;
+
+    // A silent track keeps the audio layout identical across parts
+    bool silence = reference.hasAudio && !info.hasAudio;
+    if (silence)
+    {
+        QString layout = reference.channels == 1   ? "mono"
+                         : reference.channels == 2 ? "stereo"
+                                                   : QString("%1c").arg(reference.channels);
+        args << "-f" << "lavfi"
+             << "-i" << QString("anullsrc=channel_layout=%1:sample_rate=%2").arg(layout).arg(reference.sampleRate);
+    }
+
+    // Letterbox into the common size rather than stretch
+    QString size = QString("%1:%2").arg(reference.width).arg(reference.height);
+    QString filter = QString("scale=%1:force_original_aspect_ratio=decrease,pad=%1:(ow-iw)/2:(oh-ih)/2,setsar=1,fps=%2")
+                         .arg(size)
+                         .arg(reference.frameRate);
+    if (!reference.pixelFormat.isEmpty())
+        filter += ",format=" + reference.pixelFormat;
+
+    args << "-map" << "0:v:0";
+    if (reference.hasAudio)
+        args << "-map" << (silence ? "1:a" : "0:a:0");
+
+    args << "-vf" << filter << "-c:v" << videoEncoder;
+    if (videoEncoder == "libx264" || videoEncoder == "libx265")
+        args << "-preset" << "fast" << "-crf" << "18";
+    else if (videoEncoder == "libvpx-vp9")
+        args << "-crf" << "24" << "-b:v" << "0";
+
+    // The concat demuxer keeps the first part's codec parameters, so profile and level must match too
+    args << MediaProbe::profileArguments(videoEncoder, reference);
+
+    if (reference.hasAudio)
+    {
+        QString audioEncoder = capabilities.bestEncoder(reference.audioCodec);
+        args << "-c:a" << (audioEncoder.isEmpty() ? reference.audioCodec : audioEncoder)
+             << "-ar" << QString::number(reference.sampleRate)
+             << "-ac" << QString::number(reference.channels);
+        if (silence)
+            args << "-shortest";
+    }
+
+    args << outputFile;
+    return args;
+}
+
+QList<QStringList> JoinDialog::getJoinSteps(const QString &workDir, const QString &outputFile) const
+{
+    QList<QStringList> steps;
+    QStringList files = getInputFiles();
+    QString reference = referenceKey();
+
+    // Parameters of the first clip that matches the reference
+    MediaInfo referenceInfo;
+    for (const QString &file : files)
+    {
+        if (compatibilityKey(probed.value(file)) == reference)
+        {
+            referenceInfo = probed.value(file);
+            break;
+        }
+    }
+
+    QStringList parts;
+    if (!needsReencode())
+    {
+        // The fast path: the originals go straight into the concat demuxer
+        parts = files;
+    }
+    else
+    {
+        // H.264/HEVC parts go through MPEG-TS so each keeps its own parameter sets in-band
+        bool annexB = referenceInfo.videoCodec == "h264" || referenceInfo.videoCodec == "hevc";
+        QString partFormat = annexB ? "mpegts" : "matroska";
+        QString partExtension = annexB ? "ts" : "mkv";
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            QString part = workDir + QString("/part%1.%2").arg(i, 3, 10, QChar('0')).arg(partExtension);
+            parts << part;
+
+            const MediaInfo &info = probed.value(files[i]);
+            if (compatibilityKey(info) == reference)
+            {
+                // Matching clips are only remuxed, with the same streams a re-encoded part gets
+                steps << (QStringList() << "-y" << "-i" << files[i]
+                                        << "-map" << "0:v:0" << "-map" << "0:a:0?"
+                                        << "-c" << "copy"
+                                        << "-f" << partFormat << part);
+            }
+            else
+            {
+                QStringList args = normalizeArguments(info, referenceInfo, files[i], part);
+                args.insert(args.size() - 1, "-f");
+                args.insert(args.size() - 1, partFormat);
+                steps << args;
+            }
+        }
+    }
+
+    QString listFile = workDir + "/join.txt";
+    QFile list(listFile);
+    if (list.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QTextStream stream(&list);
+        for (const QString &part : parts)
+            stream << "file '" << QFileInfo(part).absoluteFilePath().replace("'", "'\\''") << "'\n";
+    }
+
+    steps << (QStringList() << "-y"
+                            << "-f" << "concat" << "-safe" << "0"
+                            << "-i" << listFile
+                            << "-map" << "0:v" << "-map" << "0:a?"
+                            << "-c" << "copy"
+                            << outputFile);
+    return steps;
+}
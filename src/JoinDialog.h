@@ -0,0 +1,54 @@
+#ifndef JOINDIALOG_H
+#define JOINDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include "MediaProbe.h"
+
+// Joins several files end to end. Clips whose stream parameters match are
+// stream-copied through the concat demuxer; only the odd ones out are
+// re-encoded to match the rest.
+class JoinDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    JoinDialog(const QString &firstFile, QWidget *parent = nullptr);
+
+    QStringList getInputFiles() const;
+    bool needsReencode() const;
+
+    // Every step of the join, the concat last; writes the concat list into workDir
+    QList<QStringList> getJoinSteps(const QString &workDir, const QString &outputFile) const;
+
+    // Clips with equal keys can be joined without re-encoding
+    static QString compatibilityKey(const MediaInfo &info);
+
+private slots:
+    void addFiles();
+    void removeSelected();
+    void moveSelected(int offset);
+    void updateSummary();
+
+private:
+    void addFile(const QString &fileName);
+    QString referenceKey() const;
+    QStringList normalizeArguments(const MediaInfo &info, const MediaInfo &reference,
+                                   const QString &inputFile, const QString &outputFile) const;
+
+    QHash<QString, MediaInfo> probed;
+    QListWidget *fileList;
+    QPushButton *removeButton;
+    QPushButton *upButton;
+    QPushButton *downButton;
+    QLabel *summaryLabel;
+    QPushButton *okButton;
+};
+
+#endif // JOINDIALOG_H
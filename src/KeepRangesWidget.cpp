@@ -0,0 +1,131 @@
+#include "KeepRangesWidget.h"
+#include <QPainter>
+#include <QContextMenuEvent>
+#include <algorithm>
+
+KeepRangesWidget::KeepRangesWidget(QWidget *parent)
+    : QWidget(parent), duration(0), position(0), pendingIn(-1)
+{
+    setFixedHeight(16);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setToolTip("Ranges to keep. Use Mark In / Mark Out to add, right-click to remove.");
+}
+
+void KeepRangesWidget::setDuration(qint64 newDuration)
+{
+    duration = newDuration;
+    clearRanges();
+}
+
+void KeepRangesWidget::setPosition(qint64 newPosition)
+{
+    position = newPosition;
+
+    // The open range follows the playhead
+    if (pendingIn >= 0)
+        update();
+}
+
+void KeepRangesWidget::markIn(qint64 in)
+{
+    pendingIn = in;
+    update();
+}
+
+void KeepRangesWidget::markOut(qint64 out)
+{
+    if (pendingIn < 0)
+        return;
+
+    addRange(qMin(pendingIn, out), qMax(pendingIn, out));
+    pendingIn = -1;
+    update();
+}
+
+void KeepRangesWidget::clearRanges()
+{
+    keepRanges.clear();
+    pendingIn = -1;
+    update();
+    emit rangesChanged();
+}
+
+QList<KeepRangesWidget::Range> KeepRangesWidget::ranges() const
+{
+    return keepRanges;
+}
+
+bool KeepRangesWidget::hasPendingIn() const
+{
+    return pendingIn >= 0;
+}
+
+void KeepRangesWidget::addRange(qint64 start, qint64 end)
+{
+    if (end <= start)
+        return;
+
+    // Overlapping or touching ranges are merged so each stretch is exported once
+    keepRanges.append(Range(start, end));
+    std::sort(keepRanges.begin(), keepRanges.end());
+
+    QList<Range> merged;
+    for (const Range &range : keepRanges)
+    {
+        if (!merged.isEmpty() && range.first <= merged.last().second)
+            merged.last().second = qMax(merged.last().second, range.second);
+        else
+            merged.append(range);
+    }
+    keepRanges = merged;
+
+    emit rangesChanged();
+}
+
+void KeepRangesWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(50, 50, 50));
+
+    if (duration <= 0)
+        return;
+
+    for (const Range &range : keepRanges)
+    {
+        int left = xFor(range.first);
+        painter.fillRect(QRect(left, 2, qMax(1, xFor(range.second) - left), height() - 4),
+                         QColor(80, 200, 120));
+    }
+
+    if (pendingIn >= 0)
+    {
+        int left = xFor(qMin(pendingIn, position));
+        int right = xFor(qMax(pendingIn, position));
+        painter.fillRect(QRect(left, 2, qMax(1, right - left), height() - 4), QColor(80, 200, 120, 100));
+    }
+}
+
+void KeepRangesWidget::contextMenuEvent(QContextMenuEvent *event)
+{
+    if (duration <= 0 || width() <= 0)
+        return;
+
+    qint64 clicked = qint64(double(event->pos().x()) / width() * duration);
+    for (int i = 0; i < keepRanges.size(); ++i)
+    {
+        if (clicked >= keepRanges[i].first && clicked <= keepRanges[i].second)
+        {
+            keepRanges.removeAt(i);
+            update();
+            emit rangesChanged();
+            return;
+        }
+    }
+}
+
+int KeepRangesWidget::xFor(qint64 timestamp) const
+{
+    return int(double(timestamp) / duration * width());
+}
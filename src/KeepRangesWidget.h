@@ -0,0 +1,46 @@
+#ifndef KEEPRANGESWIDGET_H
+#define KEEPRANGESWIDGET_H
+
+#include <QWidget>
+#include <QList>
+#include <QPair>
+
+// Timeline strip listing the ranges to keep for a multi-range cut.
+// Right-click a range to remove it.
+class KeepRangesWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    typedef QPair<qint64, qint64> Range; // Start and end in milliseconds
+
+    KeepRangesWidget(QWidget *parent = nullptr);
+
+    void setDuration(qint64 duration);
+    void setPosition(qint64 position);
+
+    void markIn(qint64 position);
+    void markOut(qint64 position);
+    void clearRanges();
+
+    QList<Range> ranges() const;
+    bool hasPendingIn() const;
+
+signals:
+    void rangesChanged();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    void addRange(qint64 start, qint64 end);
+    int xFor(qint64 position) const;
+
+    QList<Range> keepRanges; // Sorted and non-overlapping
+    qint64 duration;
+    qint64 position;
+    qint64 pendingIn; // -1 when no in-point is waiting for its out-point
+};
+
+#endif // KEEPRANGESWIDGET_H
@@ -0,0 +1,92 @@
+#include "LogViewerDialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QScrollBar>
+#include <QFontDatabase>
+
+LogViewerDialog::LogViewerDialog(FFmpegLog *log, QWidget *parent)
+    : QDialog(parent), log(log)
+{
+    setWindowTitle("FFMPEG Log");
+    resize(800, 500);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    // Level filter
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    levelCombo = new QComboBox(this);
+    levelCombo->addItem("Errors only", FFmpegLog::Error);
+    levelCombo->addItem("Warnings and errors", FFmpegLog::Warning);
+    levelCombo->addItem("Info", FFmpegLog::Info);
+    levelCombo->addItem("Everything (including progress)", FFmpegLog::Progress);
+    levelCombo->setCurrentIndex(2);
+
+    QPushButton *clearButton = new QPushButton("Clear", this);
+
+    filterLayout->addWidget(new QLabel("Show:", this));
+    filterLayout->addWidget(levelCombo);
+    filterLayout->addStretch();
+    filterLayout->addWidget(clearButton);
+    mainLayout->addLayout(filterLayout);
+
+    // Log text
+    logView = new QPlainTextEdit(this);
+    logView->setReadOnly(true);
+    logView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    logView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    mainLayout->addWidget(logView);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    refreshTimer.setSingleShot(true);
+    refreshTimer.setInterval(250);
+    connect(&refreshTimer, &QTimer::timeout, this, &LogViewerDialog::refresh);
+
+    connect(levelCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &LogViewerDialog::refresh);
+    connect(clearButton, &QPushButton::clicked, log, &FFmpegLog::clear);
+    connect(log, &FFmpegLog::entryAdded, this, &LogViewerDialog::scheduleRefresh);
+
+    refresh();
+}
+
+void LogViewerDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    refresh();
+}
+
+void LogViewerDialog::scheduleRefresh()
+{
+    // Only redraw while visible; the log keeps collecting either way
+    if (isVisible() && !refreshTimer.isActive())
+        refreshTimer.start();
+}
+
+void LogViewerDialog::refresh()
+{
+    FFmpegLog::Level maxLevel = static_cast<FFmpegLog::Level>(levelCombo->currentData().toInt());
+
+    // Stay at the bottom if the user was following the output
+    QScrollBar *scrollBar = logView->verticalScrollBar();
+    bool following = scrollBar->value() == scrollBar->maximum();
+
+    QStringList lines;
+    for (const FFmpegLog::Entry &entry : log->entries(maxLevel))
+    {
+        lines << QString("%1 [%2] %3: %4")
+                     .arg(entry.time.toString("HH:mm:ss"))
+                     .arg(entry.job)
+                     .arg(FFmpegLog::levelName(entry.level))
+                     .arg(entry.text);
+    }
+    logView->setPlainText(lines.join('\n'));
+
+    if (following)
+        scrollBar->setValue(scrollBar->maximum());
+}
@@ -0,0 +1,33 @@
+#ifndef LOGVIEWERDIALOG_H
+#define LOGVIEWERDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QPlainTextEdit>
+#include <QTimer>
+#include "FFmpegLog.h"
+
+// Non-modal viewer for the captured ffmpeg output
+class LogViewerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    LogViewerDialog(FFmpegLog *log, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void scheduleRefresh();
+    void refresh();
+
+private:
+    FFmpegLog *log;
+
+    QComboBox *levelCombo;
+    QPlainTextEdit *logView;
+    QTimer refreshTimer; // Coalesces bursts of new lines into one redraw
+};
+
+#endif // LOGVIEWERDIALOG_H
@@ -0,0 +1,138 @@
+#include "MediaProbe.h"
+#include <QProcess>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <algorithm>
+
+namespace MediaProbe
+{
+    MediaInfo probe(const QString &file, QString *error)
+    {
+        MediaInfo info;
+
+        QProcess ffprobe;
+        ffprobe.start("ffprobe", QStringList() << "-v" << "error"
+                                               << "-show_format" << "-show_streams"
+                                               << "-of" << "json" << file);
+        if (!ffprobe.waitForFinished(10000) || ffprobe.exitCode() != 0)
+        {
+            if (error)
+                *error = QString::fromUtf8(ffprobe.readAllStandardError()).trimmed();
+            return info;
+        }
+
+        QJsonObject root = QJsonDocument::fromJson(ffprobe.readAllStandardOutput()).object();
+        QJsonObject format = root["format"].toObject();
+        info.duration = format["duration"].toString().toDouble();
+        info.formatName = format["format_name"].toString();
+
+        // First video and first audio stream win, matching ffmpeg's default stream selection
+        for (const QJsonValue &value : root["streams"].toArray())
+        {
+            QJsonObject stream = value.toObject();
+            QString type = stream["codec_type"].toString();
+
+            if (type == "video" && !info.hasVideo)
+            {
+                // Cover art is reported as a video stream; skip it
+                if (stream["disposition"].toObject()["attached_pic"].toInt() == 1)
+                    continue;
+
+                info.hasVideo = true;
+                info.videoCodec = stream["codec_name"].toString();
+                info.videoProfile = stream["profile"].toString();
+                info.videoLevel = qMax(0, stream["level"].toInt());
+                info.width = stream["width"].toInt();
+                info.height = stream["height"].toInt();
+                info.codedWidth = stream["coded_width"].toInt();
+                info.codedHeight = stream["coded_height"].toInt();
+                info.pixelFormat = stream["pix_fmt"].toString();
+                info.frameRate = stream["avg_frame_rate"].toString();
+                if (frameRateValue(info.frameRate) <= 0)
+                    info.frameRate = stream["r_frame_rate"].toString();
+
+                // Current ffprobe reports the display matrix as side data, older ones as a tag
+                for (const QJsonValue &sideData : stream["side_data_list"].toArray())
+                {
+                    if (sideData.toObject().contains("rotation"))
+                        info.rotation = sideData.toObject()["rotation"].toInt();
+                }
+                if (info.rotation == 0)
+                    info.rotation = -stream["tags"].toObject()["rotate"].toString().toInt();
+            }
+            else if (type == "audio" && !info.hasAudio)
+            {
+                info.hasAudio = true;
+                info.audioCodec = stream["codec_name"].toString();
+                info.sampleRate = stream["sample_rate"].toString().toInt();
+                info.channels = stream["channels"].toInt();
+            }
+        }
+
+        info.valid = info.hasVideo || info.hasAudio;
+        return info;
+    }
+
+    QStringList keyframeArguments(const QString &file)
+    {
+        return QStringList() << "-v" << "error"
+                             << "-select_streams" << "v:0"
+                             << "-show_entries" << "packet=pts_time,flags"
+                             << "-of" << "csv=p=0"
+                             << file;
+    }
+
+    QVector<double> parseKeyframeTimes(const QByteArray &output)
+    {
+        QVector<double> times;
+        for (const QByteArray &line : output.split('\n'))
+        {
+            // "12.345000,K__"
+            int comma = line.indexOf(',');
+            if (comma <= 0 || line.indexOf('K', comma) < 0)
+                continue;
+
+            bool ok = false;
+            double time = line.left(comma).toDouble(&ok);
+            if (ok)
+                times.append(time);
+        }
+
+        // Packets arrive in decode order
+        std::sort(times.begin(), times.end());
+        return times;
+    }
+
+    double frameRateValue(const QString &rate)
+    {
+        QStringList parts = rate.split('/');
+        if (parts.size() == 2 && parts[1].toDouble() > 0)
+            return parts[0].toDouble() / parts[1].toDouble();
+        return rate.toDouble();
+    }
+
+    QStringList profileArguments(const QString &encoder, const MediaInfo &reference)
+    {
+        // ffprobe's profile in the form libx264/libx265 take it, e.g. "High 10" -> high10
+        QStringList args;
+        QString profile = reference.videoProfile.toLower();
+        profile.replace("constrained ", "").replace(" 4:2:2", "422").replace(" 4:4:4 predictive", "444").remove(' ');
+
+        if (encoder == "libx264")
+        {
+            if (!profile.isEmpty())
+                args << "-profile:v" << profile;
+            if (reference.videoLevel > 0)
+                args << "-level" << QString::number(reference.videoLevel / 10.0, 'f', 1);
+        }
+        else if (encoder == "libx265")
+        {
+            if (!profile.isEmpty())
+                args << "-profile:v" << profile;
+            if (reference.videoLevel > 0)
+                args << "-x265-params" << "level-idc=" + QString::number(reference.videoLevel / 30.0, 'f', 1);
+        }
+        return args;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef MEDIAPROBE_H
+#define MEDIAPROBE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+
+// Stream parameters as reported by ffprobe
+struct MediaInfo
+{
+    bool valid = false;
+    double duration = 0;
+    QString formatName;
+
+    bool hasVideo = false;
+    QString videoCodec;
+    QString videoProfile;
+    int videoLevel = 0; // As ffprobe reports it: 41 for H.264 level 4.1, 123 for HEVC 4.1; 0 if unknown
+    int width = 0;
+    int height = 0;
+    int codedWidth = 0;  // Before the SPS cropping window, e.g. 1088 rows for 1080p H.264
+    int codedHeight = 0;
+    QString pixelFormat;
+    QString frameRate; // Rational string, e.g. "30000/1001"
+    int rotation = 0;  // Display matrix rotation, degrees counter-clockwise (phones store -90 or 90)
+
+    bool hasAudio = false;
+    QString audioCodec;
+    int sampleRate = 0;
+    int channels = 0;
+};
+
+namespace MediaProbe
+{
+    // Reads container and stream headers only; fast enough to call from the GUI
+    MediaInfo probe(const QString &file, QString *error = nullptr);
+
+    // ffprobe arguments that list video packet times and flags without decoding;
+    // run them asynchronously for long files and pass the output to parseKeyframeTimes
+    QStringList keyframeArguments(const QString &file);
+    QVector<double> parseKeyframeTimes(const QByteArray &output);
+
+    // Frame rate as a number, 0 if unknown
+    double frameRateValue(const QString &rate);
+
+    // -profile:v and level for libx264/libx265 so a re-encoded part matches the source it joins;
+    // empty for other encoders
+    QStringList profileArguments(const QString &encoder, const MediaInfo &reference);
+}
+
+#endif // MEDIAPROBE_H
@@ -0,0 +1,106 @@
+#include "MessageChannel.h"
+#include <QTcpSocket>
+#include <QJsonDocument>
+#include <QMessageAuthenticationCode>
+
+namespace
+{
+    const int maxHeaderBytes = 64 * 1024;
+}
+
+MessageChannel::MessageChannel(QTcpSocket *socket, QObject *parent)
+    : QObject(parent), tcpSocket(socket), pendingPayload(-1), maxPayload(maxSegmentBytes)
+{
+    tcpSocket->setParent(this);
+    connect(tcpSocket, &QTcpSocket::readyRead, this, &MessageChannel::readData);
+    connect(tcpSocket, &QTcpSocket::disconnected, this, [this]()
+            { emit closed("Connection closed"); });
+    connect(tcpSocket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError)
+            { emit closed(tcpSocket->errorString()); });
+}
+
+void MessageChannel::send(QJsonObject message, const QByteArray &payload)
+{
+    message["payload"] = double(payload.size());
+    tcpSocket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+    if (!payload.isEmpty())
+        tcpSocket->write(payload);
+}
+
+QTcpSocket *MessageChannel::socket() const
+{
+    return tcpSocket;
+}
+
+QString MessageChannel::peerName() const
+{
+    return QString("%1:%2").arg(tcpSocket->peerName().isEmpty() ? tcpSocket->peerAddress().toString()
+                                                                : tcpSocket->peerName())
+        .arg(tcpSocket->peerPort());
+}
+
+void MessageChannel::setMaxPayloadBytes(qint64 bytes)
+{
+    maxPayload = bytes;
+}
+
+QByteArray MessageChannel::authResponse(const QByteArray &token, const QByteArray &challenge)
+{
+    return QMessageAuthenticationCode::hash(challenge, token, QCryptographicHash::Sha256).toHex();
+}
+
+void MessageChannel::readData()
+{
+    buffer.append(tcpSocket->readAll());
+
+    while (true)
+    {
+        if (pendingPayload < 0)
+        {
+            int newline = buffer.indexOf('\n');
+            if (newline < 0)
+            {
+                if (buffer.size() > maxHeaderBytes)
+                    fail("Message header too long");
+                return;
+            }
+
+            QJsonParseError error;
+            QJsonDocument document = QJsonDocument::fromJson(buffer.left(newline), &error);
+            buffer.remove(0, newline + 1);
+            if (!document.isObject())
+            {
+                fail("Malformed message: " + error.errorString());
+                return;
+            }
+
+            pendingMessage = document.object();
+            pendingPayload = qint64(pendingMessage["payload"].toDouble());
+            if (pendingPayload < 0 || pendingPayload > maxPayload)
+            {
+                fail("Payload size out of range");
+                return;
+            }
+        }
+
+        if (buffer.size() < pendingPayload)
+            return;
+
+        QByteArray payload = buffer.left(pendingPayload);
+        buffer.remove(0, pendingPayload);
+        QJsonObject message = pendingMessage;
+        pendingMessage = QJsonObject();
+        pendingPayload = -1;
+
+        emit received(message, payload);
+    }
+}
+
+void MessageChannel::fail(const QString &reason)
+{
+    // A peer that breaks framing can't be resynchronised; drop it
+    tcpSocket->disconnect(this);
+    tcpSocket->abort();
+    buffer.clear();
+    emit closed(reason);
+}
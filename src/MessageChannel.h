@@ -0,0 +1,51 @@
+#ifndef MESSAGECHANNEL_H
+#define MESSAGECHANNEL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+
+class QTcpSocket;
+
+// Wire format shared by the encode coordinator and its workers: one line of
+// JSON per message, whose "payload" field gives the size of the raw bytes
+// (a media segment) that follow it. Payloads are held in memory, so their size
+// is capped; a worker allows none until the coordinator has authenticated.
+class MessageChannel : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const quint16 defaultPort = 5800;
+    static const int protocolVersion = 2;
+    static const qint64 maxSegmentBytes = qint64(512) << 20;
+
+    // Takes ownership of the socket
+    MessageChannel(QTcpSocket *socket, QObject *parent = nullptr);
+
+    void send(QJsonObject message, const QByteArray &payload = QByteArray());
+    QTcpSocket *socket() const;
+    QString peerName() const;
+    void setMaxPayloadBytes(qint64 bytes);
+
+    // Proof of the shared token for a worker's hello challenge, without sending the token itself
+    static QByteArray authResponse(const QByteArray &token, const QByteArray &challenge);
+
+signals:
+    void received(const QJsonObject &message, const QByteArray &payload);
+    void closed(const QString &reason);
+
+private slots:
+    void readData();
+
+private:
+    void fail(const QString &reason);
+
+    QTcpSocket *tcpSocket;
+    QByteArray buffer;
+    QJsonObject pendingMessage;
+    qint64 pendingPayload; // -1 while waiting for a header line
+    qint64 maxPayload;
+};
+
+#endif // MESSAGECHANNEL_H
@@ -0,0 +1,227 @@
+#include "MultiCutExporter.h"
+#include "FFmpegPipeline.h"
+#include "FFmpegCapabilities.h"
+#include "FFmpegLog.h"
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QTextStream>
+#include <QFileInfo>
+#include <algorithm>
+
+MultiCutExporter::MultiCutExporter(FFmpegLog *log, QObject *parent)
+    : QObject(parent), log(log), keyframeProbe(nullptr), pipeline(nullptr), workDir(nullptr),
+      reencodedHeads(0), snappedStarts(0)
+{
+}
+
+MultiCutExporter::~MultiCutExporter()
+{
+    cancel();
+}
+
+void MultiCutExporter::start(const QString &sourceFile, const QList<Range> &ranges, const QString &outputFile)
+{
+    cancel();
+    this->sourceFile = sourceFile;
+    this->outputFile = outputFile;
+    this->ranges = ranges;
+    reencodedHeads = 0;
+    snappedStarts = 0;
+
+    QString error;
+    info = MediaProbe::probe(sourceFile, &error);
+    if (!info.hasVideo)
+    {
+        emit finished(false, error.isEmpty() ? "No video stream found" : error);
+        return;
+    }
+
+    // Packet flags come from the demuxer, so this is quick even for long files
+    keyframeProbe = new QProcess(this);
+    connect(keyframeProbe, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus)
+            {
+                QByteArray output = keyframeProbe->readAllStandardOutput();
+                QString error = QString::fromUtf8(keyframeProbe->readAllStandardError()).trimmed();
+                keyframeProbe->deleteLater();
+                keyframeProbe = nullptr;
+
+                QVector<double> keyframes = MediaProbe::parseKeyframeTimes(output);
+                if (exitCode != 0 || keyframes.isEmpty())
+                {
+                    emit finished(false, error.isEmpty() ? "Could not read keyframes" : error);
+                    return;
+                }
+                buildPipeline(keyframes);
+            });
+    keyframeProbe->start("ffprobe", MediaProbe::keyframeArguments(sourceFile));
+}
+
+void MultiCutExporter::cancel()
+{
+    if (keyframeProbe)
+    {
+        keyframeProbe->disconnect(this);
+        keyframeProbe->kill();
+        keyframeProbe->deleteLater();
+        keyframeProbe = nullptr;
+    }
+
+    delete pipeline;
+    pipeline = nullptr;
+    delete workDir;
+    workDir = nullptr;
+}
+
+QString MultiCutExporter::headEncoder() const
+{
+    // Heads must match the copied stream closely enough for the concat to play through
+    QString encoder;
+    if (info.videoCodec == "h264")
+        encoder = "libx264";
+    else if (info.videoCodec == "hevc")
+        encoder = "libx265";
+
+    if (!encoder.isEmpty() && !FFmpegCapabilities::instance().hasEncoder(encoder))
+        encoder.clear();
+    return encoder;
+}
+
+void MultiCutExporter::buildPipeline(const QVector<double> &keyframes)
+{
+    workDir = new QTemporaryDir();
+    if (!workDir->isValid())
+    {
+        emit finished(false, "Could not create a temporary directory");
+        return;
+    }
+
+    const QString encoder = headEncoder();
+
+    // MPEG-TS parts concatenate cleanly for H.264/HEVC; other codecs only stream-copy
+    const QString partFormat = encoder.isEmpty() ? "matroska" : "mpegts";
+    const QString partExtension = encoder.isEmpty() ? "mkv" : "ts";
+
+    // Anything closer than half a frame to a keyframe counts as on it
+    double fps = MediaProbe::frameRateValue(info.frameRate);
+    const double tolerance = fps > 0 ? 0.5 / fps : 0.02;
+
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName(), this);
+    QStringList parts;
+
+    auto copyPart = [&](double start, double end)
+    {
+        QString part = workDir->filePath(QString("part%1.%2").arg(parts.size(), 3, 10, QChar('0')).arg(partExtension));
+        parts << part;
+
+        // Input seeking with stream copy starts at the keyframe at or before -ss
+        pipeline->addStep(QStringList() << "-y"
+                                        << "-ss" << QString::number(start + 0.001, 'f', 3)
+                                        << "-i" << sourceFile
+                                        << "-t" << QString::number(end - start, 'f', 3)
+                                        << "-map" << "0:v:0" << "-map" << "0:a?"
+                                        << "-c" << "copy"
+                                        << "-avoid_negative_ts" << "make_zero"
+                                        << "-f" << partFormat << part);
+    };
+
+    for (const Range &range : ranges)
+    {
+        double start = range.first / 1000.0;
+        double end = range.second / 1000.0;
+
+        auto next = std::lower_bound(keyframes.constBegin(), keyframes.constEnd(), start - tolerance);
+        double keyframe = next != keyframes.constEnd() ? *next : end;
+
+        if (keyframe - start <= tolerance)
+        {
+            copyPart(keyframe, end);
+            continue;
+        }
+
+        if (encoder.isEmpty())
+        {
+            // No matching encoder: fall back to the keyframe before the cut
+            double previous = next != keyframes.constBegin() ? *(next - 1) : keyframes.first();
+            copyPart(previous, end);
+            ++snappedStarts;
+            continue;
+        }
+
+        // Re-encode only up to the first keyframe inside the range
+        double headEnd = qMin(keyframe, end);
+        QString head = workDir->filePath(QString("part%1.%2").arg(parts.size(), 3, 10, QChar('0')).arg(partExtension));
+        parts << head;
+
+        QStringList args;
+        args << "-y"
+             << "-ss" << QString::number(start, 'f', 3)
+             << "-i" << sourceFile
+             << "-t" << QString::number(headEnd - start, 'f', 3)
+             << "-map" << "0:v:0" << "-map" << "0:a?"
+             << "-c:v" << encoder << "-preset" << "fast" << "-crf" << "16";
+        // The concat demuxer keeps the first part's parameters, so heads must match the copied parts.
+        // Timestamps need no care: every MPEG-TS part runs on the same 90 kHz clock
+        args << MediaProbe::profileArguments(encoder, info);
+        if (!info.pixelFormat.isEmpty())
+            args << "-pix_fmt" << info.pixelFormat;
+        if (fps > 0)
+            args << "-r" << info.frameRate;
+        // Audio frames are all keyframes, so audio can be copied even here
+        args << "-c:a" << "copy"
+             << "-f" << partFormat << head;
+        pipeline->addStep(args);
+        ++reencodedHeads;
+
+        if (end - keyframe > tolerance)
+            copyPart(keyframe, end);
+    }
+
+    QString listFile = workDir->filePath("parts.txt");
+    QFile list(listFile);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        emit finished(false, "Could not write the part list");
+        return;
+    }
+    QTextStream stream(&list);
+    for (QString part : parts)
+        stream << "file '" << part.replace("'", "'\\''") << "'\n";
+    list.close();
+
+    pipeline->addBarrier();
+    pipeline->addStep(QStringList() << "-y"
+                                    << "-f" << "concat" << "-safe" << "0"
+                                    << "-i" << listFile
+                                    << "-map" << "0" << "-c" << "copy"
+                                    << outputFile);
+
+    // Parts are independent reads of the source, so a couple can run side by side
+    pipeline->setMaxParallel(2);
+
+    connect(pipeline, &FFmpegPipeline::progress, this, &MultiCutExporter::progress);
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+                delete workDir;
+                workDir = nullptr;
+
+                if (!success)
+                {
+                    emit finished(false, error);
+                    return;
+                }
+
+                QString message = QString("Exported %1 range(s)").arg(ranges.size());
+                if (reencodedHeads > 0)
+                    message += QString(", %1 re-encoded up to the first keyframe").arg(reencodedHeads);
+                if (snappedStarts > 0)
+                    message += QString(", %1 moved back to the previous keyframe").arg(snappedStarts);
+                emit finished(true, message);
+            });
+
+    pipeline->start();
+}
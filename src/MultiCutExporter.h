@@ -0,0 +1,54 @@
+#ifndef MULTICUTEXPORTER_H
+#define MULTICUTEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include "MediaProbe.h"
+
+class QProcess;
+class QTemporaryDir;
+class FFmpegLog;
+class FFmpegPipeline;
+
+// Exports several kept ranges of one file as a single output without
+// re-encoding the whole thing. Each range is stream-copied from its first
+// keyframe; only the few frames between the cut point and that keyframe are
+// re-encoded with a matching encoder. The parts are joined with the concat demuxer.
+class MultiCutExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QPair<qint64, qint64> Range; // Start and end in milliseconds
+
+    MultiCutExporter(FFmpegLog *log, QObject *parent = nullptr);
+    ~MultiCutExporter();
+
+    void start(const QString &sourceFile, const QList<Range> &ranges, const QString &outputFile);
+    void cancel();
+
+signals:
+    void progress(int completedSteps, int totalSteps);
+    void finished(bool success, const QString &message);
+
+private:
+    void buildPipeline(const QVector<double> &keyframes);
+    QString headEncoder() const;
+
+    FFmpegLog *log;
+    QString sourceFile;
+    QString outputFile;
+    QList<Range> ranges;
+    MediaInfo info;
+
+    QProcess *keyframeProbe;
+    FFmpegPipeline *pipeline;
+    QTemporaryDir *workDir;
+    int reencodedHeads;
+    int snappedStarts;
+};
+
+#endif // MULTICUTEXPORTER_H
@@ -0,0 +1,227 @@
+#include "PacketAnalyzer.h"
+#include <QProcess>
+#include <QByteArray>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    // Parses one comma-separated field and moves past it; locale-independent and allocation-free,
+    // which matters at hundreds of thousands of lines
+    template <typename T>
+    bool parseField(const char *&field, const char *end, T *value)
+    {
+        const char *comma = static_cast<const char *>(std::memchr(field, ',', end - field));
+        const char *fieldEnd = comma ? comma : end;
+        std::from_chars_result parsed = std::from_chars(field, fieldEnd, *value);
+        field = comma ? comma + 1 : end;
+        return parsed.ec == std::errc() && parsed.ptr == fieldEnd;
+    }
+
+    // Floating-point from_chars is missing from some standard libraries (Apple's libc++ among them);
+    // QByteArray's parser is just as locale-independent and a raw view of the field doesn't copy it
+    bool parseField(const char *&field, const char *end, double *value)
+    {
+        const char *comma = static_cast<const char *>(std::memchr(field, ',', end - field));
+        const char *fieldEnd = comma ? comma : end;
+        bool ok = false;
+        *value = QByteArray::fromRawData(field, int(fieldEnd - field)).toDouble(&ok);
+        field = comma ? comma + 1 : end;
+        return ok;
+    }
+}
+
+double PacketAnalysis::kbps(double start, double end) const
+{
+    int seconds = cumulativeBytes.size() - 1;
+    int first = qBound(0, int(std::floor(start)), seconds);
+    int last = qBound(first, int(std::ceil(end)), seconds);
+    if (last == first)
+        return 0;
+    return (cumulativeBytes[last] - cumulativeBytes[first]) * 8 / 1000.0 / (last - first);
+}
+
+double PacketAnalysis::peakKbps() const
+{
+    qint64 peak = 0;
+    for (int i = 1; i < cumulativeBytes.size(); ++i)
+        peak = qMax(peak, cumulativeBytes[i] - cumulativeBytes[i - 1]);
+    return peak * 8 / 1000.0;
+}
+
+bool PacketAnalysis::gopAt(double time, int *first, int *next) const
+{
+    // Last keyframe at or before time
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                               [this](double t, int index)
+                               { return t < times[index]; });
+    if (it == keyframes.begin())
+        return false;
+
+    *first = *(it - 1);
+    *next = it == keyframes.end() ? packetCount() : *it;
+    return true;
+}
+
+PacketAnalyzer::PacketAnalyzer(QObject *parent)
+    : QObject(parent), process(nullptr), duration(0), lastReported(0)
+{
+}
+
+PacketAnalyzer::~PacketAnalyzer()
+{
+    cancel();
+}
+
+void PacketAnalyzer::start(const QString &videoFile, double durationSeconds)
+{
+    cancel();
+
+    result = PacketAnalysis();
+    duration = durationSeconds;
+    lastReported = 0;
+
+    // Grown geometrically anyway; a 30 fps guess saves the early reallocations
+    int expected = int(qBound(0.0, durationSeconds * 30, 2e7));
+    result.times.reserve(expected);
+    result.sizes.reserve(expected);
+    result.keyframe.reserve(expected);
+
+    process = new QProcess(this);
+    connect(process, &QProcess::readyReadStandardOutput, this, &PacketAnalyzer::readPackets);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                readPackets();
+                QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+                process->deleteLater();
+                process = nullptr;
+
+                if (exitStatus != QProcess::NormalExit || exitCode != 0 || result.times.isEmpty())
+                {
+                    emit finished(false, error.isEmpty() ? "No video packets found" : error);
+                    return;
+                }
+
+                finishAnalysis();
+                emit finished(true, QString());
+            });
+
+    // Packet headers only: nothing is decoded
+    process->start("ffprobe", QStringList() << "-v" << "error"
+                                            << "-select_streams" << "v:0"
+                                            << "-show_entries" << "packet=pts_time,dts_time,size,flags"
+                                            << "-of" << "csv=p=0"
+                                            << videoFile);
+}
+
+void PacketAnalyzer::cancel()
+{
+    if (!process)
+        return;
+
+    process->disconnect(this);
+    process->kill();
+    process->waitForFinished(1000);
+    delete process;
+    process = nullptr;
+    buffer.clear();
+}
+
+bool PacketAnalyzer::isRunning() const
+{
+    return process != nullptr;
+}
+
+const PacketAnalysis &PacketAnalyzer::analysis() const
+{
+    return result;
+}
+
+void PacketAnalyzer::readPackets()
+{
+    buffer.append(process->readAllStandardOutput());
+
+    char *data = buffer.data();
+    int consumed = 0;
+    for (;;)
+    {
+        char *newline = static_cast<char *>(std::memchr(data + consumed, '\n', buffer.size() - consumed));
+        if (!newline)
+            break;
+        *newline = '\0';
+        parseLine(data + consumed);
+        consumed = int(newline - data) + 1;
+    }
+    buffer.remove(0, consumed);
+
+    // A few updates per second of media is plenty for a progress display
+    if (!result.times.isEmpty() && result.times.last() - lastReported >= 10)
+    {
+        lastReported = result.times.last();
+        emit progress(lastReported, duration);
+    }
+}
+
+void PacketAnalyzer::parseLine(char *line)
+{
+    // "12.345000,12.278000,4521,K__"; pts is "N/A" for some B-frame packets
+    const char *field = line;
+    const char *end = line + std::strlen(line);
+    if (end > line && end[-1] == '\r')
+        --end;
+
+    double pts = 0;
+    double dts = 0;
+    quint32 size = 0;
+    bool hasPts = parseField(field, end, &pts);
+    bool hasDts = parseField(field, end, &dts);
+    if (!parseField(field, end, &size) || (!hasPts && !hasDts))
+        return;
+
+    result.times.append(float(hasPts ? pts : dts));
+    result.sizes.append(size);
+    result.keyframe.append(field < end && *field == 'K' ? 1 : 0);
+}
+
+void PacketAnalyzer::finishAnalysis()
+{
+    // Packets arrive in decode order; plot in presentation order
+    int count = result.times.size();
+    QVector<int> order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b)
+                     { return result.times[a] < result.times[b]; });
+
+    PacketAnalysis sorted;
+    sorted.times.resize(count);
+    sorted.sizes.resize(count);
+    sorted.keyframe.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        sorted.times[i] = result.times[order[i]];
+        sorted.sizes[i] = result.sizes[order[i]];
+        sorted.keyframe[i] = result.keyframe[order[i]];
+        if (sorted.keyframe[i])
+            sorted.keyframes.append(i);
+    }
+
+    // Bins are on the same timeline as the player; packets before zero count toward the first second
+    sorted.duration = qMax(duration, double(sorted.times.last()));
+    int seconds = int(std::ceil(sorted.duration)) + 1;
+
+    QVector<qint64> perSecond(seconds, 0);
+    for (int i = 0; i < count; ++i)
+        perSecond[qBound(0, int(sorted.times[i]), seconds - 1)] += sorted.sizes[i];
+
+    sorted.cumulativeBytes.resize(seconds + 1);
+    sorted.cumulativeBytes[0] = 0;
+    for (int i = 0; i < seconds; ++i)
+        sorted.cumulativeBytes[i + 1] = sorted.cumulativeBytes[i] + perSecond[i];
+
+    result = std::move(sorted);
+}
@@ -0,0 +1,263 @@
+#include "PacketAnalyzerDialog.h"
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QToolTip>
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QVector>
+
+namespace
+{
+    const int keyframeStripHeight = 12;
+    const double gopShare = 0.25; // Of the widget's height, below the keyframe strip
+
+    QString formatTime(double seconds)
+    {
+        int minutes = int(seconds) / 60;
+        return QString("%1:%2").arg(minutes).arg(seconds - minutes * 60, 4, 'f', 1, QChar('0'));
+    }
+}
+
+BitrateTimeline::BitrateTimeline(QWidget *parent)
+    : QWidget(parent), analysis(nullptr), playhead(-1)
+{
+    setMinimumHeight(220);
+    setMouseTracking(true);
+}
+
+void BitrateTimeline::setAnalysis(const PacketAnalysis *newAnalysis)
+{
+    analysis = newAnalysis;
+    update();
+}
+
+void BitrateTimeline::setPlayhead(double seconds)
+{
+    // Only the two columns the marker moves between need repainting
+    int oldX = xAt(playhead);
+    playhead = seconds;
+    int newX = xAt(playhead);
+    if (oldX != newX)
+    {
+        update(oldX - 1, 0, 3, height());
+        update(newX - 1, 0, 3, height());
+    }
+}
+
+double BitrateTimeline::timeAt(int x) const
+{
+    if (!analysis || width() <= 0)
+        return 0;
+    return analysis->duration * x / width();
+}
+
+int BitrateTimeline::xAt(double seconds) const
+{
+    if (!analysis || analysis->duration <= 0 || seconds < 0)
+        return -10;
+    return int(seconds / analysis->duration * width());
+}
+
+void BitrateTimeline::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (!analysis || analysis->packetCount() == 0 || analysis->duration <= 0)
+        return;
+
+    int gopHeight = int(height() * gopShare);
+    int barsBottom = height() - gopHeight - keyframeStripHeight;
+
+    // One value per column, averaged over at least a whole second
+    QVector<double> columns(width());
+    double peak = 1;
+    for (int x = 0; x < width(); ++x)
+    {
+        double start = timeAt(x);
+        double end = qMax(timeAt(x + 1), start + 1);
+        columns[x] = analysis->kbps(start, end);
+        peak = qMax(peak, columns[x]);
+    }
+
+    QColor barColor = palette().highlight().color();
+    for (int x = 0; x < width(); ++x)
+    {
+        int barHeight = int(columns[x] / peak * (barsBottom - 14));
+        if (barHeight > 0)
+            painter.fillRect(x, barsBottom - barHeight, 1, barHeight, barColor);
+    }
+
+    // Keyframe ticks, at most one per column
+    painter.setPen(palette().text().color());
+    int lastX = -1;
+    for (int index : analysis->keyframes)
+    {
+        int x = xAt(analysis->times[index]);
+        if (x == lastX)
+            continue;
+        painter.drawLine(x, barsBottom + 2, x, barsBottom + keyframeStripHeight - 2);
+        lastX = x;
+    }
+
+    // GOP lengths as a step plot: each GOP spans from its keyframe to the next
+    const QVector<int> &keyframes = analysis->keyframes;
+    double longest = 0;
+    for (int i = 0; i < keyframes.size(); ++i)
+    {
+        double end = i + 1 < keyframes.size() ? analysis->times[keyframes[i + 1]] : analysis->duration;
+        longest = qMax(longest, end - analysis->times[keyframes[i]]);
+    }
+
+    QColor gopColor(90, 160, 90);
+    int gopTop = height() - gopHeight;
+    for (int i = 0; i < keyframes.size() && longest > 0; ++i)
+    {
+        double start = analysis->times[keyframes[i]];
+        double end = i + 1 < keyframes.size() ? analysis->times[keyframes[i + 1]] : analysis->duration;
+        int x0 = xAt(start);
+        int x1 = qMax(x0 + 1, xAt(end));
+        int h = qMax(1, int((end - start) / longest * (gopHeight - 2)));
+        painter.fillRect(x0, height() - h, x1 - x0, h, gopColor);
+    }
+
+    if (playhead >= 0)
+    {
+        painter.setPen(QColor(220, 50, 50));
+        int x = xAt(playhead);
+        painter.drawLine(x, 0, x, height());
+    }
+
+    painter.setPen(palette().text().color());
+    painter.drawLine(0, gopTop, width(), gopTop);
+    painter.drawText(rect().adjusted(2, 0, -2, 0), Qt::AlignTop | Qt::AlignLeft,
+                     QString("%1 kbps").arg(peak, 0, 'f', 0));
+    painter.drawText(rect().adjusted(2, gopTop, -2, 0), Qt::AlignTop | Qt::AlignLeft,
+                     QString("GOP up to %1 s").arg(longest, 0, 'f', 2));
+    painter.drawText(rect().adjusted(2, 0, -2, 0), Qt::AlignTop | Qt::AlignRight,
+                     formatTime(analysis->duration));
+}
+
+void BitrateTimeline::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && analysis)
+        emit timeClicked(timeAt(int(event->position().x())));
+}
+
+void BitrateTimeline::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!analysis || analysis->packetCount() == 0)
+        return;
+
+    double time = timeAt(int(event->position().x()));
+    QString text = QString("%1  %2 kbps").arg(formatTime(time)).arg(analysis->kbps(time, time + 1), 0, 'f', 0);
+
+    int first = 0;
+    int next = 0;
+    if (analysis->gopAt(time, &first, &next))
+    {
+        double end = next < analysis->packetCount() ? analysis->times[next] : analysis->duration;
+        text += QString("\nGOP %1 s, %2 frames").arg(end - analysis->times[first], 0, 'f', 2).arg(next - first);
+    }
+
+    QToolTip::showText(event->globalPosition().toPoint(), text, this);
+}
+
+PacketAnalyzerDialog::PacketAnalyzerDialog(QWidget *parent)
+    : QDialog(parent), analyzer(new PacketAnalyzer(this))
+{
+    setWindowTitle("Packet Analyzer");
+    resize(900, 380);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    statusLabel = new QLabel(this);
+    mainLayout->addWidget(statusLabel);
+
+    timeline = new BitrateTimeline(this);
+    mainLayout->addWidget(timeline, 1);
+
+    summaryLabel = new QLabel(this);
+    summaryLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    mainLayout->addWidget(summaryLabel);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    connect(timeline, &BitrateTimeline::timeClicked, this, &PacketAnalyzerDialog::seekRequested);
+    connect(analyzer, &PacketAnalyzer::progress, this, [this](double seconds, double total)
+            {
+        if (total > 0)
+            statusLabel->setText(QString("Reading packets... %1%").arg(qMin(100, int(100 * seconds / total))));
+        else
+            statusLabel->setText("Reading packets... " + formatTime(seconds)); });
+    connect(analyzer, &PacketAnalyzer::finished, this, &PacketAnalyzerDialog::analysisFinished);
+}
+
+void PacketAnalyzerDialog::setVideoFile(const QString &file, double durationSeconds)
+{
+    if (file == videoFile && (analyzer->isRunning() || analyzer->analysis().packetCount() > 0))
+        return;
+
+    videoFile = file;
+    timeline->setAnalysis(nullptr);
+    summaryLabel->clear();
+    if (file.isEmpty())
+    {
+        statusLabel->setText("No video loaded");
+        return;
+    }
+
+    statusLabel->setText("Reading packets of " + QFileInfo(file).fileName() + "...");
+    analyzer->start(file, durationSeconds);
+}
+
+void PacketAnalyzerDialog::setPlayhead(double seconds)
+{
+    timeline->setPlayhead(seconds);
+}
+
+void PacketAnalyzerDialog::analysisFinished(bool success, const QString &error)
+{
+    if (!success)
+    {
+        statusLabel->setText("Analysis failed: " + error);
+        return;
+    }
+
+    const PacketAnalysis &analysis = analyzer->analysis();
+    timeline->setAnalysis(&analysis);
+    statusLabel->setText(QFileInfo(videoFile).fileName() + " (hover for details, click to seek)");
+
+    qint64 totalBytes = analysis.cumulativeBytes.last();
+    double averageKbps = analysis.duration > 0 ? totalBytes * 8 / 1000.0 / analysis.duration : 0;
+
+    // GOP lengths in frames; the last one runs to the end of the stream
+    int shortest = 0;
+    int longest = 0;
+    const QVector<int> &keyframes = analysis.keyframes;
+    for (int i = 0; i < keyframes.size(); ++i)
+    {
+        int frames = (i + 1 < keyframes.size() ? keyframes[i + 1] : analysis.packetCount()) - keyframes[i];
+        shortest = i == 0 ? frames : qMin(shortest, frames);
+        longest = qMax(longest, frames);
+    }
+    double averageGop = keyframes.isEmpty() ? 0 : double(analysis.packetCount() - keyframes.first()) / keyframes.size();
+
+    summaryLabel->setText(QString("Packets:   %1 over %2\n"
+                                  "Bitrate:   %3 kbps average, %4 kbps peak second\n"
+                                  "Keyframes: %5, GOP %6 / %7 / %8 frames (min / avg / max)")
+                              .arg(analysis.packetCount())
+                              .arg(formatTime(analysis.duration))
+                              .arg(averageKbps, 0, 'f', 0)
+                              .arg(analysis.peakKbps(), 0, 'f', 0)
+                              .arg(keyframes.size())
+                              .arg(shortest)
+                              .arg(averageGop, 0, 'f', 1)
+                              .arg(longest));
+}
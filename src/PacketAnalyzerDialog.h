@@ -0,0 +1,67 @@
+#ifndef PACKETANALYZERDIALOG_H
+#define PACKETANALYZERDIALOG_H
+
+#include <QDialog>
+#include <QWidget>
+#include <QLabel>
+#include <QString>
+#include "PacketAnalyzer.h"
+
+// Bitrate per second, keyframe ticks and GOP lengths on one shared timeline.
+// Every column is drawn from the cumulative byte counts, so painting costs the
+// same for a minute-long clip as for a multi-hour file.
+class BitrateTimeline : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit BitrateTimeline(QWidget *parent = nullptr);
+
+    // Not owned; must outlive the widget or be replaced
+    void setAnalysis(const PacketAnalysis *analysis);
+    void setPlayhead(double seconds);
+
+signals:
+    void timeClicked(double seconds);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    double timeAt(int x) const;
+    int xAt(double seconds) const;
+
+    const PacketAnalysis *analysis;
+    double playhead;
+};
+
+// Non-modal packet analyzer for the loaded file; clicking the timeline seeks the player
+class PacketAnalyzerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit PacketAnalyzerDialog(QWidget *parent = nullptr);
+
+    // Starts a new analysis when the file differs from the one shown
+    void setVideoFile(const QString &file, double durationSeconds);
+    void setPlayhead(double seconds);
+
+signals:
+    void seekRequested(double seconds);
+
+private slots:
+    void analysisFinished(bool success, const QString &error);
+
+private:
+    QString videoFile;
+    PacketAnalyzer *analyzer;
+
+    QLabel *statusLabel;
+    QLabel *summaryLabel;
+    BitrateTimeline *timeline;
+};
+
+#endif // PACKETANALYZERDIALOG_H
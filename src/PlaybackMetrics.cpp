@@ -0,0 +1,197 @@
+#include "PlaybackMetrics.h"
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QJsonArray>
+#include <algorithm>
+
+namespace
+{
+    const int lagCapacity = 600;
+}
+
+PlaybackMetrics::PlaybackMetrics(QObject *parent)
+    : QObject(parent), nominalFrameRate(0), playbackRate(1.0)
+{
+    clock.start();
+    reset();
+}
+
+PlaybackMetrics::~PlaybackMetrics()
+{
+    attach(nullptr);
+}
+
+void PlaybackMetrics::attach(QVideoSink *newSink)
+{
+    if (sink)
+        disconnect(sink, nullptr, this, nullptr);
+    sink = newSink;
+
+    // Direct so the arrival time is taken where the frame is delivered, not after a queue hop
+    if (sink)
+        connect(sink, &QVideoSink::videoFrameChanged, this, &PlaybackMetrics::frameArrived,
+                Qt::DirectConnection);
+}
+
+bool PlaybackMetrics::isAttached() const
+{
+    return sink != nullptr;
+}
+
+void PlaybackMetrics::reset()
+{
+    QMutexLocker locker(&mutex);
+    framesShown = 0;
+    droppedFrames = 0;
+    lateFrames = 0;
+    lastArrival = -1;
+    lastPts = -1;
+    anchorPts = -1;
+    anchorArrival = -1;
+    histogram.fill(0, histogramBins + 1);
+    recentArrivals.clear();
+    lagSamples.clear();
+    lagNext = 0;
+    positionUpdates = 0;
+    positionHandlerTotal = 0;
+}
+
+void PlaybackMetrics::restartSchedule()
+{
+    QMutexLocker locker(&mutex);
+    anchorPts = -1;
+    lastArrival = -1;
+    lastPts = -1;
+}
+
+void PlaybackMetrics::setNominalFrameRate(double fps)
+{
+    QMutexLocker locker(&mutex);
+    nominalFrameRate = fps;
+}
+
+void PlaybackMetrics::setPlaybackRate(double rate)
+{
+    QMutexLocker locker(&mutex);
+    playbackRate = rate > 0 ? rate : 1.0;
+    anchorPts = -1;
+}
+
+void PlaybackMetrics::recordPositionUpdate(qint64 handlerNanoseconds)
+{
+    QMutexLocker locker(&mutex);
+    ++positionUpdates;
+    positionHandlerTotal += handlerNanoseconds;
+}
+
+void PlaybackMetrics::frameArrived(const QVideoFrame &frame)
+{
+    if (!frame.isValid())
+        return;
+
+    qint64 now = clock.nsecsElapsed();
+    qint64 pts = frame.startTime();
+
+    QMutexLocker locker(&mutex);
+    ++framesShown;
+
+    if (lastArrival >= 0)
+    {
+        qint64 interval = (now - lastArrival) / 1000;
+        histogram[qMin(int(interval / histogramBinMicros), int(histogramBins))]++;
+    }
+    lastArrival = now;
+
+    recentArrivals.append(now);
+    while (!recentArrivals.isEmpty() && now - recentArrivals.first() > 1000000000LL)
+        recentArrivals.removeFirst();
+
+    if (pts < 0)
+        return;
+
+    double frameMicros = nominalFrameRate > 0 ? 1e6 / nominalFrameRate : 1e6 / 30;
+
+    // A backwards or large jump is a seek; start a new schedule from this frame
+    if (anchorPts < 0 || lastPts < 0 || pts < lastPts || pts - lastPts > 2000000)
+    {
+        anchorPts = pts;
+        anchorArrival = now;
+        lastPts = pts;
+        return;
+    }
+
+    qint64 gap = pts - lastPts;
+    if (gap > frameMicros * 1.5)
+        droppedFrames += qRound(gap / frameMicros) - 1;
+    lastPts = pts;
+
+    // Lag behind where this timestamp should have appeared; an early frame moves the anchor
+    double ideal = anchorArrival + (pts - anchorPts) * 1000.0 / playbackRate;
+    qint64 lag = qint64((now - ideal) / 1000.0);
+    if (lag < 0)
+    {
+        anchorArrival += lag * 1000;
+        lag = 0;
+    }
+    if (lag > frameMicros)
+        ++lateFrames;
+
+    if (lagSamples.size() < lagCapacity)
+        lagSamples.append(lag);
+    else
+        lagSamples[lagNext] = lag;
+    lagNext = (lagNext + 1) % lagCapacity;
+}
+
+PlaybackMetrics::Snapshot PlaybackMetrics::snapshot() const
+{
+    QMutexLocker locker(&mutex);
+
+    Snapshot snap;
+    snap.nominalFrameRate = nominalFrameRate;
+    snap.playbackRate = playbackRate;
+    snap.framesShown = framesShown;
+    snap.droppedFrames = droppedFrames;
+    snap.lateFrames = lateFrames;
+    snap.histogram = histogram;
+    snap.positionUpdates = positionUpdates;
+    snap.positionHandlerAvgUs = positionUpdates > 0 ? positionHandlerTotal / 1000.0 / positionUpdates : 0;
+
+    // Frames in the last second, unless playback stopped a while ago
+    qint64 now = clock.nsecsElapsed();
+    if (recentArrivals.size() > 1 && now - recentArrivals.last() < 500000000LL)
+        snap.effectiveFps = (recentArrivals.size() - 1) * 1e9 / (recentArrivals.last() - recentArrivals.first());
+
+    if (!lagSamples.isEmpty())
+    {
+        QVector<qint64> sorted = lagSamples;
+        std::sort(sorted.begin(), sorted.end());
+        snap.lagMedianMs = sorted[sorted.size() / 2] / 1000.0;
+        snap.lagP95Ms = sorted[qMin(int(sorted.size() * 95 / 100), int(sorted.size()) - 1)] / 1000.0;
+    }
+    return snap;
+}
+
+QJsonObject PlaybackMetrics::toJson() const
+{
+    Snapshot snap = snapshot();
+
+    QJsonArray bins;
+    for (qint64 count : snap.histogram)
+        bins.append(count);
+
+    QJsonObject json;
+    json["framesShown"] = snap.framesShown;
+    json["droppedFrames"] = snap.droppedFrames;
+    json["lateFrames"] = snap.lateFrames;
+    json["effectiveFps"] = snap.effectiveFps;
+    json["lagMedianMs"] = snap.lagMedianMs;
+    json["lagP95Ms"] = snap.lagP95Ms;
+    json["positionUpdates"] = snap.positionUpdates;
+    json["positionHandlerAvgUs"] = snap.positionHandlerAvgUs;
+    json["histogramBinMs"] = histogramBinMicros / 1000.0;
+    json["frameIntervalHistogram"] = bins;
+    json["nominalFrameRate"] = snap.nominalFrameRate;
+    json["playbackRate"] = snap.playbackRate;
+    return json;
+}
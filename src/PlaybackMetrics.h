@@ -0,0 +1,85 @@
+#ifndef PLAYBACKMETRICS_H
+#define PLAYBACKMETRICS_H
+
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QPointer>
+
+class QVideoSink;
+class QVideoFrame;
+
+// Frame pacing statistics for the preview player. Frames are tapped straight
+// from the video sink as they are handed to the renderer, and each one is
+// compared with where its timestamp says it should have appeared. The sink only
+// sees frames once they are decoded, so this is pacing, not decode latency.
+class PlaybackMetrics : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int histogramBins = 50;     // 2 ms each
+    static const int histogramBinMicros = 2000;
+
+    struct Snapshot
+    {
+        double nominalFrameRate = 0; // 0 when the source doesn't say
+        double playbackRate = 1.0;
+        qint64 framesShown = 0;
+        qint64 droppedFrames = 0; // Timestamps skipped between consecutive frames
+        qint64 lateFrames = 0;    // Presented more than a frame behind schedule
+        double effectiveFps = 0;  // Over the last second
+        double lagMedianMs = 0;   // Presentation lag behind the timestamp schedule
+        double lagP95Ms = 0;
+        qint64 positionUpdates = 0;
+        double positionHandlerAvgUs = 0; // Time spent updating the slider and waveform
+        QVector<qint64> histogram;       // Frame intervals; last bin collects everything longer
+    };
+
+    explicit PlaybackMetrics(QObject *parent = nullptr);
+    ~PlaybackMetrics();
+
+    // Starts tapping a sink; nullptr stops
+    void attach(QVideoSink *sink);
+    bool isAttached() const;
+
+    void reset();
+    // Call after seeks, pauses and rate changes so the schedule is re-anchored
+    void restartSchedule();
+    void setNominalFrameRate(double fps);
+    void setPlaybackRate(double rate);
+    void recordPositionUpdate(qint64 handlerNanoseconds);
+
+    Snapshot snapshot() const;
+    QJsonObject toJson() const;
+
+private:
+    void frameArrived(const QVideoFrame &frame);
+
+    mutable QMutex mutex; // Frames can arrive on the renderer's thread
+    QPointer<QVideoSink> sink;
+    QElapsedTimer clock;
+
+    double nominalFrameRate;
+    double playbackRate;
+
+    qint64 framesShown;
+    qint64 droppedFrames;
+    qint64 lateFrames;
+    qint64 lastArrival; // ns on clock, -1 before the first frame
+    qint64 lastPts;     // us, -1 when unknown
+    qint64 anchorPts;
+    qint64 anchorArrival;
+
+    QVector<qint64> histogram;
+    QVector<qint64> recentArrivals; // Arrival times within the last second
+    QVector<qint64> lagSamples;     // Ring of recent lags in us
+    int lagNext;
+
+    qint64 positionUpdates;
+    qint64 positionHandlerTotal;
+};
+
+#endif // PLAYBACKMETRICS_H
@@ -0,0 +1,195 @@
+#include "PlaybackMetricsDialog.h"
+#include "MediaProbe.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QPainter>
+#include <QFileDialog>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QMessageBox>
+#include <QFontDatabase>
+#include <cmath>
+
+FrameTimeHistogram::FrameTimeHistogram(QWidget *parent)
+    : QWidget(parent), expectedIntervalMs(0)
+{
+    setMinimumHeight(120);
+}
+
+void FrameTimeHistogram::setBins(const QVector<qint64> &newBins, double expected)
+{
+    bins = newBins;
+    expectedIntervalMs = expected;
+    update();
+}
+
+void FrameTimeHistogram::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (bins.isEmpty())
+        return;
+
+    qint64 peak = 1;
+    for (qint64 count : bins)
+        peak = qMax(peak, count);
+
+    // Log scale so a handful of hitches stays visible next to thousands of on-time frames
+    double binWidth = double(width()) / bins.size();
+    double scale = (height() - 14) / std::log(double(peak) + 1);
+    for (int i = 0; i < bins.size(); ++i)
+    {
+        if (bins[i] == 0)
+            continue;
+        int barHeight = qMax(1, int(std::log(double(bins[i]) + 1) * scale));
+        QColor color = i == bins.size() - 1 ? QColor(200, 60, 60) : palette().highlight().color();
+        painter.fillRect(QRectF(i * binWidth, height() - barHeight, binWidth - 1, barHeight), color);
+    }
+
+    // Marker at the nominal frame interval
+    double binMs = PlaybackMetrics::histogramBinMicros / 1000.0;
+    if (expectedIntervalMs > 0)
+    {
+        int x = int(expectedIntervalMs / binMs * binWidth);
+        painter.setPen(QPen(palette().text().color(), 1, Qt::DashLine));
+        painter.drawLine(x, 0, x, height());
+    }
+
+    painter.setPen(palette().text().color());
+    painter.drawText(rect().adjusted(2, 0, -2, 0), Qt::AlignTop | Qt::AlignLeft, "0 ms");
+    painter.drawText(rect().adjusted(2, 0, -2, 0), Qt::AlignTop | Qt::AlignRight,
+                     QString("%1+ ms").arg(PlaybackMetrics::histogramBins * binMs, 0, 'f', 0));
+}
+
+PlaybackMetricsDialog::PlaybackMetricsDialog(PlaybackMetrics *metrics, QVideoSink *sink, QWidget *parent)
+    : QDialog(parent), metrics(metrics), sink(sink)
+{
+    setWindowTitle("Playback Metrics");
+    resize(420, 360);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    statsLabel = new QLabel(this);
+    statsLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    statsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    mainLayout->addWidget(statsLabel);
+
+    mainLayout->addWidget(new QLabel("Frame intervals:", this));
+    histogram = new FrameTimeHistogram(this);
+    mainLayout->addWidget(histogram);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *resetButton = new QPushButton("Reset", this);
+    QPushButton *exportButton = new QPushButton("Export...", this);
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(exportButton);
+    buttonLayout->addStretch();
+    mainLayout->addLayout(buttonLayout);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    refreshTimer.setInterval(250);
+    connect(&refreshTimer, &QTimer::timeout, this, &PlaybackMetricsDialog::refresh);
+
+    connect(resetButton, &QPushButton::clicked, [this]()
+            {
+        this->metrics->reset();
+        refresh(); });
+    connect(exportButton, &QPushButton::clicked, this, &PlaybackMetricsDialog::exportReport);
+}
+
+void PlaybackMetricsDialog::setVideoFile(const QString &file)
+{
+    videoFile = file;
+}
+
+void PlaybackMetricsDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+
+    // Counting starts fresh each time the window is opened
+    metrics->reset();
+    metrics->attach(sink);
+    refreshTimer.start();
+    refresh();
+}
+
+void PlaybackMetricsDialog::hideEvent(QHideEvent *event)
+{
+    // Nothing is measured, and playback pays nothing, while closed
+    refreshTimer.stop();
+    metrics->attach(nullptr);
+    QDialog::hideEvent(event);
+}
+
+void PlaybackMetricsDialog::refresh()
+{
+    PlaybackMetrics::Snapshot snap = metrics->snapshot();
+    double nominal = snap.nominalFrameRate;
+    double rate = snap.playbackRate;
+    double expectedMs = nominal > 0 ? 1000.0 / (nominal * rate) : 0;
+
+    QStringList lines;
+    lines << QString("Frames shown:      %1").arg(snap.framesShown)
+          << QString("Effective fps:     %1 (nominal %2)")
+                 .arg(snap.effectiveFps, 0, 'f', 1)
+                 .arg(nominal > 0 ? QString::number(nominal * rate, 'f', 2) : QString("unknown"))
+          << QString("Dropped frames:    %1").arg(snap.droppedFrames)
+          << QString("Late frames:       %1").arg(snap.lateFrames)
+          << QString("Lag p50 / p95:     %1 / %2 ms")
+                 .arg(snap.lagMedianMs, 0, 'f', 1)
+                 .arg(snap.lagP95Ms, 0, 'f', 1)
+          << QString("Position updates:  %1 (avg %2 us each)")
+                 .arg(snap.positionUpdates)
+                 .arg(snap.positionHandlerAvgUs, 0, 'f', 0);
+    statsLabel->setText(lines.join('\n'));
+
+    histogram->setBins(snap.histogram, expectedMs);
+}
+
+void PlaybackMetricsDialog::exportReport()
+{
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Export Playback Metrics", "playback-metrics.json",
+                                                    "JSON Files (*.json)");
+    if (fileName.isEmpty())
+        return;
+
+    QJsonObject report;
+    report["captured"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    report["platform"] = QSysInfo::prettyProductName();
+    report["metrics"] = metrics->toJson();
+
+    // Source parameters make most pacing reports reproducible
+    if (!videoFile.isEmpty())
+    {
+        MediaInfo info = MediaProbe::probe(videoFile);
+        QJsonObject source;
+        source["file"] = QFileInfo(videoFile).fileName();
+        source["codec"] = info.videoCodec;
+        source["profile"] = info.videoProfile;
+        source["width"] = info.width;
+        source["height"] = info.height;
+        source["pixelFormat"] = info.pixelFormat;
+        source["frameRate"] = info.frameRate;
+        report["source"] = source;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        QMessageBox::warning(this, "Export Failed", "Could not write " + fileName);
+        return;
+    }
+    file.write(QJsonDocument(report).toJson());
+}
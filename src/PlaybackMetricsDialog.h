@@ -0,0 +1,59 @@
+#ifndef PLAYBACKMETRICSDIALOG_H
+#define PLAYBACKMETRICSDIALOG_H
+
+#include <QDialog>
+#include <QWidget>
+#include <QLabel>
+#include <QTimer>
+#include <QVector>
+#include "PlaybackMetrics.h"
+
+class QVideoSink;
+
+// Bar chart of frame-to-frame intervals
+class FrameTimeHistogram : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FrameTimeHistogram(QWidget *parent = nullptr);
+
+    void setBins(const QVector<qint64> &bins, double expectedIntervalMs);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<qint64> bins;
+    double expectedIntervalMs;
+};
+
+// Non-modal frame pacing window; the sink is only tapped while it is open
+class PlaybackMetricsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    PlaybackMetricsDialog(PlaybackMetrics *metrics, QVideoSink *sink, QWidget *parent = nullptr);
+
+    void setVideoFile(const QString &file);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void exportReport();
+
+private:
+    PlaybackMetrics *metrics;
+    QVideoSink *sink;
+    QString videoFile;
+
+    QLabel *statsLabel;
+    FrameTimeHistogram *histogram;
+    QTimer refreshTimer;
+};
+
+#endif // PLAYBACKMETRICSDIALOG_H
@@ -0,0 +1,279 @@
+#include "QualityVerifier.h"
+#include "FFmpegPipeline.h"
+#include "FFmpegArguments.h"
+#include "FFmpegCapabilities.h"
+#include "FFmpegLog.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <cmath>
+
+namespace
+{
+    // Same pixel format and a timeline starting at zero on both sides, so frames pair up
+    const char *normalize = "format=yuv420p,settb=AVTB,setpts=PTS-STARTPTS";
+}
+
+QJsonObject QualityReport::toJson() const
+{
+    QJsonObject json;
+    if (ssim >= 0)
+    {
+        json["ssim"] = ssim;
+        json["worstWindowSsim"] = worstWindowSsim;
+    }
+    if (psnr >= 0)
+        json["psnr"] = psnr;
+    if (vmaf >= 0)
+        json["vmaf"] = vmaf;
+    json["windows"] = windows;
+    json["frames"] = frames;
+    return json;
+}
+
+QString QualityReport::summary() const
+{
+    QStringList parts;
+    if (ssim >= 0)
+        parts << QString("SSIM %1 (worst %2)").arg(ssim, 0, 'f', 3).arg(worstWindowSsim, 0, 'f', 3);
+    if (psnr >= 0)
+        parts << QString("PSNR %1 dB").arg(psnr, 0, 'f', 1);
+    if (vmaf >= 0)
+        parts << QString("VMAF %1").arg(vmaf, 0, 'f', 1);
+    return parts.join(", ");
+}
+
+QualityVerifier::QualityVerifier(FFmpegLog *log, QObject *parent)
+    : QObject(parent), log(log), pipeline(nullptr), workDir(nullptr), windowsStarted(0), measureVmaf(false)
+{
+}
+
+QualityVerifier::~QualityVerifier()
+{
+    cancel();
+}
+
+bool QualityVerifier::canVerify(const QStringList &args)
+{
+    // Nothing was re-encoded, or there is no single output to compare
+    if (args.size() < 2 || args.contains("-filter_complex") || args.contains("-f"))
+        return false;
+    if (FFmpegArguments::optionValue(args, "-c") == "copy" || FFmpegArguments::optionValue(args, "-c:v") == "copy")
+        return false;
+    if (QFileInfo(args.last()).suffix().toLower() == "gif")
+        return false;
+
+    // Rotated or flipped pictures don't match the source pixel for pixel
+    if (args.contains("-display_rotation"))
+        return false;
+
+    // Retimed frames no longer line up with the source, and neither do turned ones
+    const QStringList filters = FFmpegArguments::optionValue(args, "-vf").split(',', Qt::SkipEmptyParts);
+    for (const QString &filter : filters)
+    {
+        if (filter.startsWith("setpts") || filter.startsWith("fps") || filter.startsWith("select"))
+            return false;
+        if (filter.startsWith("transpose") || filter == "hflip" || filter == "vflip")
+            return false;
+    }
+    return true;
+}
+
+double QualityVerifier::averageSsim(const QString &statsFile, int *frames)
+{
+    double total = 0;
+    int count = 0;
+
+    // One line per frame: "n:1 Y:0.991 U:0.995 V:0.994 All:0.992 (20.97)"
+    static const QRegularExpression all("All:([0-9.]+)");
+    QFile file(statsFile);
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream stream(&file);
+        while (!stream.atEnd())
+        {
+            QRegularExpressionMatch match = all.match(stream.readLine());
+            if (match.hasMatch())
+            {
+                total += match.captured(1).toDouble();
+                ++count;
+            }
+        }
+    }
+
+    if (frames)
+        *frames = count;
+    return count > 0 ? total / count : 0;
+}
+
+QString QualityVerifier::referenceFilter(const QStringList &args)
+{
+    // Only geometry; frame dropping such as mpdecimate is covered by pairing frames on timestamps
+    QStringList geometry;
+    const QStringList filters = FFmpegArguments::optionValue(args, "-vf").split(',', Qt::SkipEmptyParts);
+    for (const QString &filter : filters)
+    {
+        if (filter.startsWith("crop=") || filter.startsWith("scale="))
+            geometry << filter;
+    }
+    return geometry.join(',');
+}
+
+void QualityVerifier::start(const QString &sourceFile, double sourceStart, const QString &outputFile,
+                            double durationSeconds, const QString &referenceFilter)
+{
+    cancel();
+
+    result = QualityReport();
+    workDir = new QTemporaryDir();
+    measureVmaf = FFmpegCapabilities::instance().hasFilter("libvmaf");
+
+    // Short files are compared whole
+    int windows = durationSeconds > windowCount * windowSeconds ? windowCount : 1;
+    double length = windows > 1 ? windowSeconds : durationSeconds;
+
+    QString reference = referenceFilter.isEmpty() ? QString(normalize) : referenceFilter + "," + normalize;
+    int metrics = measureVmaf ? 3 : 2;
+    reference += QString(",split=%1").arg(metrics);
+    for (int i = 0; i < metrics; ++i)
+        reference += QString("[r%1]").arg(i);
+
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName() + " (quality)", this);
+    pipeline->setMaxParallel(windows);
+
+    for (int window = 0; window < windows; ++window)
+    {
+        double start = windows > 1 ? (window + 0.5) * durationSeconds / windows - length / 2 : 0;
+
+        // ssim and psnr pass their first input through, so the metrics chain
+        QString graph = QString("[0:v]%1[dist];[1:v]%2;"
+                                "[dist][r0]ssim=stats_file=%3[a];[a][r1]psnr=stats_file=%4")
+                            .arg(QString(normalize), reference,
+                                 FFmpegArguments::filterPath(statsFile(window, "ssim")),
+                                 FFmpegArguments::filterPath(statsFile(window, "psnr")));
+        if (measureVmaf)
+            graph += QString("[b];[b][r2]libvmaf=log_fmt=json:log_path=%1").arg(FFmpegArguments::filterPath(statsFile(window, "vmaf")));
+
+        pipeline->addStep(QStringList()
+                          << "-ss" << QString::number(start, 'f', 3) << "-t" << QString::number(length, 'f', 3)
+                          << "-i" << outputFile
+                          << "-ss" << QString::number(sourceStart + start, 'f', 3) << "-t" << QString::number(length, 'f', 3)
+                          << "-i" << sourceFile
+                          << "-filter_complex" << graph
+                          << "-an" << "-f" << "null" << "-");
+    }
+    windowsStarted = windows;
+
+    connect(pipeline, &FFmpegPipeline::progress, this, &QualityVerifier::progress);
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+                if (success)
+                    readResults();
+
+                delete workDir;
+                workDir = nullptr;
+
+                if (success && result.frames == 0)
+                    emit finished(false, "No frames were compared");
+                else
+                    emit finished(success, error);
+            });
+    pipeline->start();
+}
+
+void QualityVerifier::cancel()
+{
+    if (pipeline)
+    {
+        pipeline->disconnect(this);
+        pipeline->cancel();
+        pipeline->deleteLater();
+        pipeline = nullptr;
+    }
+    delete workDir;
+    workDir = nullptr;
+}
+
+QualityReport QualityVerifier::report() const
+{
+    return result;
+}
+
+QString QualityVerifier::statsFile(int window, const QString &metric) const
+{
+    return workDir->path() + QString("/%1%2.log").arg(metric).arg(window);
+}
+
+void QualityVerifier::readResults()
+{
+    // "n:1 mse_avg:0.53 mse_y:0.70 ... psnr_avg:50.89 ..."
+    static const QRegularExpression psnrLine("mse_avg:([0-9.]+)");
+
+    double ssimTotal = 0;
+    double mseTotal = 0;
+    int psnrFrames = 0;
+    double vmafTotal = 0;
+    int vmafFrames = 0;
+
+    for (int window = 0; window < windowsStarted; ++window)
+    {
+        int windowFrames = 0;
+        double mean = averageSsim(statsFile(window, "ssim"), &windowFrames);
+        if (windowFrames > 0)
+        {
+            if (result.worstWindowSsim < 0 || mean < result.worstWindowSsim)
+                result.worstWindowSsim = mean;
+            ssimTotal += mean * windowFrames;
+            result.frames += windowFrames;
+            ++result.windows;
+        }
+
+        QFile psnrFile(statsFile(window, "psnr"));
+        if (psnrFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            QTextStream stream(&psnrFile);
+            while (!stream.atEnd())
+            {
+                QRegularExpressionMatch match = psnrLine.match(stream.readLine());
+                if (match.hasMatch())
+                {
+                    mseTotal += match.captured(1).toDouble();
+                    ++psnrFrames;
+                }
+            }
+        }
+
+        QFile vmafFile(statsFile(window, "vmaf"));
+        if (measureVmaf && vmafFile.open(QIODevice::ReadOnly))
+        {
+            QJsonObject root = QJsonDocument::fromJson(vmafFile.readAll()).object();
+            int frames = root["frames"].toArray().size();
+            double mean = root["pooled_metrics"].toObject()["vmaf"].toObject()["mean"].toDouble(-1);
+            if (frames > 0 && mean >= 0)
+            {
+                vmafTotal += mean * frames;
+                vmafFrames += frames;
+            }
+        }
+    }
+
+    if (result.frames > 0)
+        result.ssim = ssimTotal / result.frames;
+
+    // As ffmpeg reports it: from the mean error rather than the mean of per-frame dB values,
+    // capped where identical frames would make it infinite
+    if (psnrFrames > 0)
+    {
+        double mse = mseTotal / psnrFrames;
+        result.psnr = mse > 0 ? qMin(100.0, 10.0 * std::log10(255.0 * 255.0 / mse)) : 100.0;
+    }
+
+    if (vmafFrames > 0)
+        result.vmaf = vmafTotal / vmafFrames;
+}
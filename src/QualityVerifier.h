@@ -0,0 +1,79 @@
+#ifndef QUALITYVERIFIER_H
+#define QUALITYVERIFIER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+class FFmpegLog;
+class FFmpegPipeline;
+
+// Objective quality of an export, averaged over the sampled frames.
+// A metric that was not computed is negative.
+struct QualityReport
+{
+    double ssim = -1;
+    double worstWindowSsim = -1; // Lowest per-window mean, to catch one bad scene
+    double psnr = -1;            // dB, from the mean squared error of all frames
+    double vmaf = -1;
+    int windows = 0;
+    int frames = 0;
+
+    QJsonObject toJson() const;
+
+    // e.g. "SSIM 0.987 (worst 0.971), PSNR 41.2 dB, VMAF 94.1"
+    QString summary() const;
+};
+
+// Compares an export with its source over a few short windows spread across
+// the file, decoded in parallel. The source gets the export's crop and scale
+// so both sides have the same geometry; SSIM and PSNR are always measured and
+// VMAF when ffmpeg was built with libvmaf.
+class QualityVerifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    QualityVerifier(FFmpegLog *log, QObject *parent = nullptr);
+    ~QualityVerifier();
+
+    // Single re-encoded output whose frames line up with the source's; stream
+    // copies, speed changes, rotations, GIFs, playlists and ladders are not comparable
+    static bool canVerify(const QStringList &exportArguments);
+
+    // The crop and scale filters of an export's -vf, empty if it has none
+    static QString referenceFilter(const QStringList &exportArguments);
+
+    // Mean of the per-frame values in an ssim filter stats file, 0 if it has none
+    static double averageSsim(const QString &statsFile, int *frames = nullptr);
+
+    // sourceStart is where output time 0 lies in the source (a trim's start);
+    // durationSeconds is the output's duration
+    void start(const QString &sourceFile, double sourceStart, const QString &outputFile,
+               double durationSeconds, const QString &referenceFilter);
+    void cancel();
+
+    QualityReport report() const;
+
+signals:
+    void progress(int completedWindows, int totalWindows);
+    void finished(bool success, const QString &error);
+
+private:
+    static const int windowCount = 4;
+    static const int windowSeconds = 5;
+
+    QString statsFile(int window, const QString &metric) const;
+    void readResults();
+
+    FFmpegLog *log;
+    FFmpegPipeline *pipeline;
+    QTemporaryDir *workDir;
+    int windowsStarted;
+    bool measureVmaf;
+    QualityReport result;
+};
+
+#endif // QUALITYVERIFIER_H
@@ -1,4 +1,7 @@
 #include "ResizeDialog.h"
+#include "FFmpegCapabilities.h"
+#include "ScaleBenchmark.h"
+#include "ExportPreview.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -10,10 +13,21 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QProcess>
+#include <QFileInfo>
+#include <QThread>
+#include <cmath>
+
+namespace
+{
+    const int referenceKbps = 5000;         // 1080p H.264 rung
+    const double referencePixels = 1920.0 * 1080.0;
+    const int ladderKeyframeSeconds = 2;    // Shared by every rung so players can switch at any keyframe
+}
 
 ResizeDialog::ResizeDialog(const QString &videoFile, int videoWidth, int videoHeight, QWidget *parent)
     : QDialog(parent), videoFile(videoFile), originalWidth(videoWidth), originalHeight(videoHeight),
-      aspectRatio((double)videoWidth / videoHeight), updatingControls(false)
+      aspectRatio((double)videoWidth / videoHeight), benchmark(new ScaleBenchmark(this)),
+      updatingControls(false)
 {
     setWindowTitle("Resize Video");
     setMinimumWidth(400);
@@ -67,6 +81,7 @@ ResizeDialog::ResizeDialog(const QString &videoFile, int videoWidth, int videoHe
     presetCombo->addItem("4K (3840x2160)");
     presetCombo->addItem("50%");
     presetCombo->addItem("25%");
+    presetCombo->addItem("Ladder (several sizes at once)", "ladder");
 
     presetLayout->addWidget(presetLabel);
     presetLayout->addWidget(presetCombo);
@@ -80,8 +95,43 @@ ResizeDialog::ResizeDialog(const QString &videoFile, int videoWidth, int videoHe
     algorithmCombo->addItem("Spline", "spline");
     formLayout->addRow("Scaling Algorithm:", algorithmCombo);
 
+    // Large downscales are often bound by a single-threaded scaler, not the encoder
+    threadsInput = new QSpinBox(this);
+    threadsInput->setRange(1, 64);
+    threadsInput->setValue(QThread::idealThreadCount());
+    formLayout->addRow("Scaler threads:", threadsInput);
+
+    // Measures every algorithm at the chosen size on this machine
+    QHBoxLayout *calibrationLayout = new QHBoxLayout();
+    calibrateButton = new QPushButton("Calibrate", this);
+    calibrationLabel = new QLabel("Measure each algorithm's speed at this size", this);
+    calibrationLabel->setWordWrap(true);
+    calibrationLayout->addWidget(calibrateButton);
+    calibrationLayout->addWidget(calibrationLabel, 1);
+    formLayout->addRow(calibrationLayout);
+
     mainLayout->addLayout(formLayout);
 
+    // Ladder rungs, shown when the ladder preset is selected
+    ladderGroupBox = new QGroupBox("Ladder sizes (one output file each)", this);
+    QVBoxLayout *ladderLayout = new QVBoxLayout(ladderGroupBox);
+    const QSize ladderSizes[] = {QSize(1280, 720), QSize(1920, 1080), QSize(2560, 1440), QSize(3840, 2160)};
+    const char *ladderNames[] = {"HD", "Full HD", "2K", "4K"};
+    for (int i = 0; i < 4; ++i)
+    {
+        QCheckBox *rung = new QCheckBox(QString("%1 (%2x%3)")
+                                            .arg(ladderNames[i])
+                                            .arg(ladderSizes[i].width())
+                                            .arg(ladderSizes[i].height()),
+                                        this);
+        rung->setProperty("ladderSize", ladderSizes[i]);
+        rung->setChecked(i < 2);
+        ladderLayout->addWidget(rung);
+        ladderCheckboxes.append(rung);
+    }
+    ladderGroupBox->setVisible(false);
+    mainLayout->addWidget(ladderGroupBox);
+
     // Connect signals
     connect(widthInput, QOverload<int>::of(&QSpinBox::valueChanged),
             this, &ResizeDialog::updateHeight);
@@ -91,6 +141,16 @@ ResizeDialog::ResizeDialog(const QString &videoFile, int videoWidth, int videoHe
             this, &ResizeDialog::aspectRatioToggled);
     connect(presetCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &ResizeDialog::onPresetChanged);
+    connect(calibrateButton, &QPushButton::clicked, this, &ResizeDialog::runCalibration);
+    connect(benchmark, &ScaleBenchmark::measured, this, &ResizeDialog::showCalibration);
+    connect(benchmark, &ScaleBenchmark::finished, [this]()
+            {
+        calibrateButton->setEnabled(true);
+        calibrationLabel->setText(QString("Source megapixels per second, %1 thread(s)").arg(threadsInput->value())); });
+    connect(benchmark, &ScaleBenchmark::failed, [this](const QString &error)
+            {
+        calibrateButton->setEnabled(true);
+        calibrationLabel->setText("Calibration failed: " + error); });
 
     // Update preview when values change
     connect(widthInput, QOverload<int>::of(&QSpinBox::valueChanged),
@@ -103,6 +163,10 @@ ResizeDialog::ResizeDialog(const QString &videoFile, int videoWidth, int videoHe
         QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    // Encodes a few seconds at the playhead with these settings and plays them in the main window
+    exportPreviewButton = new ExportPreviewButton(this);
+    buttonBox->addButton(exportPreviewButton, QDialogButtonBox::ActionRole);
     mainLayout->addWidget(buttonBox);
 
     // Initialize preview
@@ -129,15 +193,104 @@ QString ResizeDialog::getScalingAlgorithm() const
     return algorithmCombo->currentData().toString();
 }
 
+int ResizeDialog::getThreadCount() const
+{
+    return threadsInput->value();
+}
+
+bool ResizeDialog::isLadderExport() const
+{
+    return presetCombo->currentData().toString() == "ladder";
+}
+
+QList<QSize> ResizeDialog::getLadderSizes() const
+{
+    QList<QSize> sizes;
+    for (QCheckBox *rung : ladderCheckboxes)
+    {
+        if (rung->isChecked())
+            sizes.append(rung->property("ladderSize").toSize());
+    }
+    return sizes;
+}
+
+QString ResizeDialog::ladderOutputFile(const QString &outputFile, const QSize &size)
+{
+    // movie.mp4 -> movie_720p.mp4
+    QFileInfo info(outputFile);
+    return info.path() + "/" + info.completeBaseName() +
+           QString("_%1p.").arg(size.height()) + info.suffix();
+}
+
+int ResizeDialog::ladderBitrate(const QSize &size)
+{
+    // Bits per pixel fall as resolution grows, so scale by pixel count to the 0.75 power
+    double pixels = double(size.width()) * size.height();
+    return qMax(200, int(std::lround(referenceKbps * std::pow(pixels / referencePixels, 0.75) / 10)) * 10);
+}
+
+QStringList ResizeDialog::getLadderArguments(const QString &outputFile) const
+{
+    QList<QSize> sizes = getLadderSizes();
+    QString encoder = FFmpegCapabilities::instance().bestEncoder("h264");
+
+    // Decode once, then split the frames into one scale branch per rung
+    QStringList branches;
+    QString splitOutputs;
+    for (int i = 0; i < sizes.size(); ++i)
+    {
+        splitOutputs += QString("[s%1]").arg(i);
+
+        // With aspect ratio kept, only the height is fixed and the width follows (rounded to even)
+        int width = getMaintainAspectRatio() ? -2 : sizes[i].width();
+        branches << QString("[s%1]%2[v%1]")
+                        .arg(i)
+                        .arg(ScaleBenchmark::scaleFilter(width, sizes[i].height(),
+                                                         getScalingAlgorithm(), getThreadCount()));
+    }
+    QString filterGraph = QString("[0:v]split=%1%2;").arg(sizes.size()).arg(splitOutputs) +
+                          branches.join(';');
+
+    QStringList args;
+    args << "-y"                            // Overwrite output files without asking
+         << ScaleBenchmark::threadArguments(getThreadCount(), true)
+         << "-i" << videoFile               // Input file
+         << "-filter_complex" << filterGraph; // Shared decode, fanned out
+
+    // Each rung gets its own encoder instance and output file, with a capped target bitrate
+    // so the renditions form a ladder, and keyframes at the same times across all of them
+    for (int i = 0; i < sizes.size(); ++i)
+    {
+        int kbps = ladderBitrate(sizes[i]);
+        args << "-map" << QString("[v%1]").arg(i)
+             << "-map" << "0:a?"
+             << "-c:v" << encoder
+             << "-b:v" << QString::number(kbps) + "k"
+             << "-maxrate" << QString::number(kbps) + "k"
+             << "-bufsize" << QString::number(kbps * 2) + "k"
+             << "-force_key_frames" << QString("expr:gte(t,n_forced*%1)").arg(ladderKeyframeSeconds)
+             << "-c:a" << "copy"
+             << ladderOutputFile(outputFile, sizes[i]);
+    }
+
+    return args;
+}
+
 QStringList ResizeDialog::getFFMPEGArguments(const QString &outputFile) const
+{
+    return buildArguments(videoFile, getWidth(), getHeight(), getScalingAlgorithm(), outputFile,
+                          getThreadCount());
+}
+
+QStringList ResizeDialog::buildArguments(const QString &videoFile, int width, int height,
+                                         const QString &algorithm, const QString &outputFile,
+                                         int threads)
 {
     QStringList args;
-    QString scaleFilter = QString("scale=%1:%2:flags=%3")
-                              .arg(getWidth())
-                              .arg(getHeight())
-                              .arg(getScalingAlgorithm());
+    QString scaleFilter = ScaleBenchmark::scaleFilter(width, height, algorithm, threads);
 
     args << "-y"                 // Overwrite output files without asking
+         << ScaleBenchmark::threadArguments(threads)
          << "-i" << videoFile    // Input file
          << "-vf" << scaleFilter // Scale video filter
          << "-c:a" << "copy"     // Copy audio codec (no re-encode)
@@ -186,6 +339,14 @@ void ResizeDialog::aspectRatioToggled(bool checked)
 
 void ResizeDialog::onPresetChanged(int index)
 {
+    // The ladder replaces the single width/height
+    bool ladder = presetCombo->itemData(index).toString() == "ladder";
+    ladderGroupBox->setVisible(ladder);
+    widthInput->setEnabled(!ladder);
+    heightInput->setEnabled(!ladder);
+    if (ladder)
+        return;
+
     if (index == 0)
     {
         // Custom - do nothing
@@ -270,4 +431,43 @@ void ResizeDialog::updatePreview()
 
     // Set the preview label
     previewLabel->setPixmap(pixmap);
-}
\ No newline at end of file
+}
+
+void ResizeDialog::runCalibration()
+{
+    // Ladder rungs are measured at the first selected size
+    QSize target(getWidth(), getHeight());
+    if (isLadderExport() && !getLadderSizes().isEmpty())
+        target = getLadderSizes().first();
+
+    QStringList algorithms;
+    for (int i = 0; i < algorithmCombo->count(); ++i)
+    {
+        algorithms << algorithmCombo->itemData(i).toString();
+        algorithmCombo->setItemText(i, algorithmCombo->itemText(i).section(" (", 0, 0));
+    }
+
+    calibrateButton->setEnabled(false);
+    calibrationLabel->setText(QString("Measuring %1x%2 -> %3x%4...")
+                                  .arg(originalWidth)
+                                  .arg(originalHeight)
+                                  .arg(target.width())
+                                  .arg(target.height()));
+    benchmark->start(QSize(originalWidth, originalHeight), target, algorithms, getThreadCount());
+}
+
+void ResizeDialog::showCalibration(const QString &algorithm, double megapixelsPerSecond)
+{
+    int index = algorithmCombo->findData(algorithm);
+    if (index < 0)
+        return;
+
+    QString name = algorithmCombo->itemText(index).section(" (", 0, 0);
+    algorithmCombo->setItemText(index, QString("%1 (%2 MP/s)").arg(name).arg(megapixelsPerSecond, 0, 'f', 0));
+}
+
+void ResizeDialog::setExportPreview(ExportPreview *preview)
+{
+    exportPreviewButton->setPreview(preview, [this](const QString &outputFile)
+                                    { return getFFMPEGArguments(outputFile); });
+}
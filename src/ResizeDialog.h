@@ -8,6 +8,14 @@
 #include <QString>
 #include <QStringList>
 #include <QLabel>
+#include <QGroupBox>
+#include <QList>
+#include <QSize>
+#include <QPushButton>
+
+class ScaleBenchmark;
+class ExportPreview;
+class ExportPreviewButton;
 
 class ResizeDialog : public QDialog
 {
@@ -20,14 +28,32 @@ public:
     int getHeight() const;
     bool getMaintainAspectRatio() const;
     QString getScalingAlgorithm() const;
+    int getThreadCount() const;
     QStringList getFFMPEGArguments(const QString &outputFile) const;
 
+    // A thread count of 0 leaves filter threading at ffmpeg's defaults
+    static QStringList buildArguments(const QString &videoFile, int width, int height,
+                                      const QString &algorithm, const QString &outputFile,
+                                      int threads = 0);
+
+    // Resolution ladder: one decode, one output per selected size
+    bool isLadderExport() const;
+    QList<QSize> getLadderSizes() const;
+    static QString ladderOutputFile(const QString &outputFile, const QSize &size);
+    static int ladderBitrate(const QSize &size); // Target kbps for a rung, 5000 at 1080p
+    QStringList getLadderArguments(const QString &outputFile) const;
+
+    // Shows the Preview Result button, which encodes through this preview
+    void setExportPreview(ExportPreview *preview);
+
 private slots:
     void updateHeight();
     void updateWidth();
     void aspectRatioToggled(bool checked);
     void onPresetChanged(int index);
     void updatePreview();
+    void runCalibration();
+    void showCalibration(const QString &algorithm, double megapixelsPerSecond);
 
 private:
     QString videoFile;
@@ -40,9 +66,17 @@ private:
     QCheckBox *aspectRatioCheckbox;
     QComboBox *presetCombo;
     QComboBox *algorithmCombo;
+    QSpinBox *threadsInput;
+    QPushButton *calibrateButton;
+    QLabel *calibrationLabel;
+    ScaleBenchmark *benchmark;
     QLabel *previewLabel;
+    QGroupBox *ladderGroupBox;
+    QList<QCheckBox *> ladderCheckboxes;
 
     bool updatingControls; // Flag to prevent recursive updates
+
+    ExportPreviewButton *exportPreviewButton;
 };
 
 #endif // RESIZEDIALOG_H
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "ResumableExport.h"
+#include "FFmpegPipeline.h"
+#include "FFmpegArguments.h"
+#include "FFmpegLog.h"
+#include "MediaProbe.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCryptographicHash>
+
+namespace
+{
+    const char *manifestName = "manifest.json";
+}
+
+ResumableExport::ResumableExport(FFmpegLog *log, QObject *parent)
+    : QObject(parent), log(log), pipeline(nullptr), duration(0), runStart(0)
+{
+    progressTimer.setInterval(2000);
+    connect(&progressTimer, &QTimer::timeout, this, &ResumableExport::pollProgress);
+}
+
+ResumableExport::~ResumableExport()
+{
+    cancel();
+}
+
+bool ResumableExport::isSupported(const QString &format)
+{
+    // HLS/DASH are segmented already; GIF can't go through Matroska
+    return format == "mp4" || format == "mov" || format == "mkv" || format == "webm" || format == "avi";
+}
+
+QString ResumableExport::workDirFor(const QString &outputFile)
+{
+    // Next to the output so it survives reboots and is found again by the same job
+    QFileInfo info(outputFile);
+    return info.absolutePath() + "/." + info.fileName() + ".parts";
+}
+
+QString ResumableExport::jobKey(const QStringList &arguments)
+{
+    // Everything but the output path, plus the source's identity
+    QStringList parts = arguments.mid(0, arguments.size() - 1);
+    QString source = FFmpegArguments::optionValue(arguments, "-i");
+    QFileInfo sourceInfo(source);
+    parts << QString::number(sourceInfo.size())
+          << QString::number(sourceInfo.lastModified().toMSecsSinceEpoch());
+
+    return QCryptographicHash::hash(parts.join(QChar(0x1f)).toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+
+QJsonObject ResumableExport::readManifest(const QString &workDir)
+{
+    QFile file(workDir + "/" + manifestName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QJsonObject();
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+QList<ResumableExport::Segment> ResumableExport::finishedSegments(const QString &workDir, const QJsonObject &manifest)
+{
+    QList<Segment> segments;
+    for (const QJsonValue &value : manifest["segments"].toArray())
+    {
+        QJsonObject entry = value.toObject();
+        Segment segment;
+        segment.file = entry["file"].toString();
+        segment.start = entry["start"].toDouble();
+        segment.end = entry["end"].toDouble();
+        segments.append(segment);
+    }
+
+    QJsonObject run = manifest["run"].toObject();
+    if (!run.isEmpty())
+        segments += listedSegments(workDir + "/" + run["list"].toString(), run["start"].toDouble());
+
+    // Keep the unbroken prefix of segments that are still on disk
+    QList<Segment> verified;
+    for (const Segment &segment : segments)
+    {
+        QFileInfo info(workDir + "/" + segment.file);
+        if (!info.exists() || info.size() == 0 || segment.end <= segment.start)
+            break;
+        verified.append(segment);
+    }
+
+    // Only the newest segment can have been cut short by a crash, so it alone is probed
+    if (!verified.isEmpty())
+    {
+        MediaInfo last = MediaProbe::probe(workDir + "/" + verified.last().file);
+        if (!last.valid || last.duration <= 0)
+            verified.removeLast();
+    }
+
+    return verified;
+}
+
+QList<ResumableExport::Segment> ResumableExport::listedSegments(const QString &listFile, double runStart)
+{
+    // The segment muxer appends a line only once a segment is complete; its
+    // times are relative to where the run started
+    QList<Segment> segments;
+    QFile list(listFile);
+    if (!list.open(QIODevice::ReadOnly))
+        return segments;
+
+    for (const QByteArray &line : list.readAll().split('\n'))
+    {
+        QList<QByteArray> fields = line.trimmed().split(',');
+        if (fields.size() < 3)
+            continue;
+
+        Segment segment;
+        segment.file = QString::fromUtf8(fields[0]);
+        segment.start = runStart + fields[1].toDouble();
+        segment.end = runStart + fields[2].toDouble();
+        segments.append(segment);
+    }
+    return segments;
+}
+
+double ResumableExport::completedSeconds(const QStringList &arguments, const QString &outputFile)
+{
+    QString workDir = workDirFor(outputFile);
+    QJsonObject manifest = readManifest(workDir);
+    if (manifest["job"].toString() != jobKey(arguments))
+        return 0;
+
+    QList<Segment> segments = finishedSegments(workDir, manifest);
+    return segments.isEmpty() ? 0 : segments.last().end;
+}
+
+void ResumableExport::discard(const QString &outputFile)
+{
+    QDir(workDirFor(outputFile)).removeRecursively();
+}
+
+void ResumableExport::start(const QStringList &exportArguments, const QString &output, double durationSeconds)
+{
+    cancel();
+    arguments = exportArguments;
+    outputFile = output;
+    duration = durationSeconds;
+    workDir = workDirFor(outputFile);
+
+    // A different job (or a changed source) invalidates whatever is there
+    QJsonObject manifest = readManifest(workDir);
+    QList<Segment> segments;
+    if (manifest["job"].toString() == jobKey(arguments))
+        segments = finishedSegments(workDir, manifest);
+    else
+        QDir(workDir).removeRecursively();
+
+    if (!QDir().mkpath(workDir))
+    {
+        emit finished(false, "Could not create " + workDir);
+        return;
+    }
+
+    double resumeAt = segments.isEmpty() ? 0 : segments.last().end;
+    if (duration > 0 && resumeAt >= duration - 0.5)
+    {
+        concatenate();
+        return;
+    }
+
+    writeManifest(segments, resumeAt, segments.size());
+    runStart = resumeAt;
+    runList = workDir + QString("/run%1.csv").arg(segments.size());
+
+    // Keyframes on every boundary so each segment starts cleanly and stands alone
+    QString length = QString::number(segmentSeconds);
+    QStringList args = FFmpegArguments::withInputStart(arguments.mid(0, arguments.size() - 1), resumeAt);
+    args << "-force_key_frames" << "expr:gte(t,n_forced*" + length + ")"
+         << "-f" << "segment"
+         << "-segment_time" << length
+         << "-segment_format" << "matroska"
+         << "-segment_start_number" << QString::number(segments.size())
+         << "-segment_list" << runList
+         << "-segment_list_type" << "csv"
+         << "-reset_timestamps" << "1"
+         << workDir + "/segment%05d.mkv";
+
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName(), this);
+    pipeline->addStep(args);
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                progressTimer.stop();
+                pipeline->deleteLater();
+                pipeline = nullptr;
+
+                if (!success)
+                {
+                    emit finished(false, error);
+                    return;
+                }
+                concatenate();
+            });
+
+    emit progress(resumeAt, duration);
+    progressTimer.start();
+    pipeline->start();
+}
+
+void ResumableExport::cancel()
+{
+    progressTimer.stop();
+    delete pipeline;
+    pipeline = nullptr;
+}
+
+void ResumableExport::writeManifest(const QList<Segment> &segments, double runStart, int firstIndex)
+{
+    QJsonArray entries;
+    for (const Segment &segment : segments)
+    {
+        QJsonObject entry;
+        entry["file"] = segment.file;
+        entry["start"] = segment.start;
+        entry["end"] = segment.end;
+        entries.append(entry);
+    }
+
+    QJsonObject run;
+    run["start"] = runStart;
+    run["list"] = QString("run%1.csv").arg(firstIndex);
+
+    QJsonObject manifest;
+    manifest["job"] = jobKey(arguments);
+    manifest["output"] = outputFile;
+    manifest["segments"] = entries;
+    manifest["run"] = run;
+
+    // Never leave a half-written manifest behind, whatever interrupts us
+    QSaveFile file(workDir + "/" + manifestName);
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(QJsonDocument(manifest).toJson());
+        file.commit();
+    }
+
+    QFile::remove(workDir + "/" + run["list"].toString());
+}
+
+void ResumableExport::pollProgress()
+{
+    // Segments from earlier runs were checked when resuming; only this run's list grows
+    QList<Segment> segments = listedSegments(runList, runStart);
+    if (!segments.isEmpty())
+        emit progress(segments.last().end, duration);
+}
+
+void ResumableExport::concatenate()
+{
+    QList<Segment> segments = finishedSegments(workDir, readManifest(workDir));
+    if (segments.isEmpty())
+    {
+        emit finished(false, "No segments were produced");
+        return;
+    }
+
+    QString listFile = workDir + "/concat.txt";
+    QFile list(listFile);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        emit finished(false, "Could not write the segment list");
+        return;
+    }
+    QTextStream stream(&list);
+    for (const Segment &segment : segments)
+    {
+        QString path = workDir + "/" + segment.file;
+        stream << "file '" << path.replace("'", "'\\''") << "'\n";
+    }
+    list.close();
+
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName(), this);
+    pipeline->addStep(QStringList() << "-y"
+                                    << "-f" << "concat" << "-safe" << "0"
+                                    << "-i" << listFile
+                                    << "-map" << "0" << "-c" << "copy"
+                                    << outputFile);
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+
+                // Segments are kept on failure so the join can be retried
+                if (success)
+                    QDir(workDir).removeRecursively();
+                emit finished(success, error);
+            });
+    pipeline->start();
+}
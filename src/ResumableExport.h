@@ -0,0 +1,75 @@
+#ifndef RESUMABLEEXPORT_H
+#define RESUMABLEEXPORT_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QJsonObject>
+#include <QTimer>
+
+class FFmpegLog;
+class FFmpegPipeline;
+
+// Runs a long export as keyframe-aligned segments in a work directory next to
+// the output, with a small manifest of the segments already finished. If the
+// job is interrupted (crash, sleep, kill), running the same job again checks the
+// finished segments and continues from the first missing one; the segments are
+// joined with a stream-copy concat at the end.
+class ResumableExport : public QObject
+{
+    Q_OBJECT
+
+public:
+    ResumableExport(FFmpegLog *log, QObject *parent = nullptr);
+    ~ResumableExport();
+
+    // Segmenting needs a single-file output whose codecs fit in Matroska
+    static bool isSupported(const QString &format);
+
+    // Seconds an interrupted run of exactly this job already produced, 0 if none
+    static double completedSeconds(const QStringList &arguments, const QString &outputFile);
+    static void discard(const QString &outputFile);
+
+    // arguments is the complete single-file command, ending in outputFile
+    void start(const QStringList &arguments, const QString &outputFile, double durationSeconds);
+    void cancel();
+
+signals:
+    void progress(double completedSeconds, double totalSeconds);
+    void finished(bool success, const QString &error);
+
+private slots:
+    void pollProgress();
+
+private:
+    static const int segmentSeconds = 60;
+
+    struct Segment
+    {
+        QString file; // Relative to the work directory
+        double start;
+        double end;
+    };
+
+    static QString workDirFor(const QString &outputFile);
+    static QString jobKey(const QStringList &arguments);
+    static QJsonObject readManifest(const QString &workDir);
+    static QList<Segment> listedSegments(const QString &listFile, double runStart);
+    static QList<Segment> finishedSegments(const QString &workDir, const QJsonObject &manifest);
+
+    void writeManifest(const QList<Segment> &segments, double runStart, int firstIndex);
+    void concatenate();
+
+    FFmpegLog *log;
+    FFmpegPipeline *pipeline;
+    QString outputFile;
+    QString workDir;
+    QStringList arguments;
+    double duration;
+    double runStart;
+    QString runList; // Segment list the current run appends to
+    QTimer progressTimer;
+};
+
+#endif // RESUMABLEEXPORT_H
@@ -0,0 +1,190 @@
+#include "RotateDialog.h"
+#include "FFmpegCapabilities.h"
+#include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTransform>
+#include <QPixmap>
+
+namespace
+{
+    const int previewSize = 360;
+}
+
+RotateDialog::RotateDialog(const QString &videoFile, const MediaInfo &info, double previewSeconds,
+                           QWidget *parent)
+    : QDialog(parent), videoFile(videoFile), info(info)
+{
+    setWindowTitle("Rotate / Flip Video");
+
+    QFormLayout *layout = new QFormLayout(this);
+
+    previewLabel = new QLabel("Loading video frame...", this);
+    previewLabel->setAlignment(Qt::AlignCenter);
+    previewLabel->setMinimumSize(previewSize, previewSize);
+    layout->addRow(previewLabel);
+
+    rotationCombo = new QComboBox(this);
+    rotationCombo->addItem("None", 0);
+    rotationCombo->addItem("90° clockwise", 90);
+    rotationCombo->addItem("180°", 180);
+    rotationCombo->addItem("90° counter-clockwise", 270);
+    layout->addRow("Rotate:", rotationCombo);
+
+    flipHorizontalCheckbox = new QCheckBox("Flip horizontally (mirror)", this);
+    flipVerticalCheckbox = new QCheckBox("Flip vertically", this);
+    layout->addRow("", flipHorizontalCheckbox);
+    layout->addRow("", flipVerticalCheckbox);
+
+    methodLabel = new QLabel(this);
+    methodLabel->setWordWrap(true);
+    QString text = hasDisplayMatrixOptions()
+                       ? "Saved as MP4 or MOV, only the orientation in the file header changes: no re-encode, "
+                         "no quality loss. Other formats are re-encoded."
+                       : "This ffmpeg is older than 6.0 and can't rewrite the orientation in the file header, "
+                         "so the video is re-encoded.";
+    if (info.rotation != 0)
+        text += QString("\nThe video is currently displayed rotated %1°.").arg(-info.rotation);
+    methodLabel->setText(text);
+    layout->addRow(methodLabel);
+
+    connect(rotationCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &RotateDialog::updatePreview);
+    connect(flipHorizontalCheckbox, &QCheckBox::toggled, this, &RotateDialog::updatePreview);
+    connect(flipVerticalCheckbox, &QCheckBox::toggled, this, &RotateDialog::updatePreview);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    // One frame at the playhead, small and already turned the way it is displayed now
+    QProcess *ffmpeg = new QProcess(this);
+    connect(ffmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            [this, ffmpeg](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                if (exitCode == 0 && still.loadFromData(ffmpeg->readAllStandardOutput(), "PNG"))
+                    updatePreview();
+                else
+                    previewLabel->setText("Could not load a video frame");
+                ffmpeg->deleteLater();
+            });
+
+    QStringList args;
+    args << "-v" << "error"
+         << "-ss" << QString::number(previewSeconds, 'f', 3)
+         << "-i" << videoFile
+         << "-frames:v" << "1"
+         << "-vf" << QString("scale=%1:%1:force_original_aspect_ratio=decrease").arg(previewSize)
+         << "-f" << "image2pipe" << "-c:v" << "png" << "-";
+    ffmpeg->start("ffmpeg", args);
+}
+
+int RotateDialog::getRotation() const
+{
+    return rotationCombo->currentData().toInt();
+}
+
+bool RotateDialog::getFlipHorizontal() const
+{
+    return flipHorizontalCheckbox->isChecked();
+}
+
+bool RotateDialog::getFlipVertical() const
+{
+    return flipVerticalCheckbox->isChecked();
+}
+
+QStringList RotateDialog::getFFMPEGArguments(const QString &outputFile) const
+{
+    return buildArguments(videoFile, info.rotation, getRotation(),
+                          getFlipHorizontal(), getFlipVertical(), outputFile);
+}
+
+bool RotateDialog::hasDisplayMatrixOptions()
+{
+    return FFmpegCapabilities::instance().hasOption("display_rotation");
+}
+
+bool RotateDialog::canRotateLosslessly(const QString &outputFile)
+{
+    if (!hasDisplayMatrixOptions())
+        return false;
+
+    QString suffix = QFileInfo(outputFile).suffix().toLower();
+    return suffix == "mp4" || suffix == "mov" || suffix == "m4v";
+}
+
+QStringList RotateDialog::buildArguments(const QString &videoFile, int sourceRotation, int rotation,
+                                         bool flipHorizontal, bool flipVertical, const QString &outputFile)
+{
+    QStringList args;
+    args << "-y";
+
+    if (!hasDisplayMatrixOptions())
+    {
+        // Autorotate applies the source's own matrix, the filters then turn the upright picture
+        QStringList filters;
+        if (rotation == 90)
+            filters << "transpose=clock";
+        else if (rotation == 180)
+            filters << "hflip" << "vflip";
+        else if (rotation == 270)
+            filters << "transpose=cclock";
+        if (flipHorizontal)
+            filters << "hflip";
+        if (flipVertical)
+            filters << "vflip";
+
+        args << "-i" << videoFile
+             << "-map" << "0:v:0" << "-map" << "0:a?";
+        if (!filters.isEmpty())
+            args << "-vf" << filters.join(',');
+        args << "-c:a" << "copy" << outputFile;
+        return args;
+    }
+
+    // Input options: they replace the stream's display matrix as it is read
+    args << "-display_rotation" << QString::number(displayRotation(sourceRotation, rotation));
+    if (flipHorizontal)
+        args << "-display_hflip";
+    if (flipVertical)
+        args << "-display_vflip";
+
+    args << "-i" << videoFile
+         << "-map" << "0:v:0" << "-map" << "0:a?";
+
+    if (canRotateLosslessly(outputFile))
+        args << "-c" << "copy"; // Only the track header's matrix changes
+    else
+        args << "-c:a" << "copy"; // Matrix baked into the pixels by autorotate
+
+    args << outputFile;
+    return args;
+}
+
+int RotateDialog::displayRotation(int sourceRotation, int rotation)
+{
+    int degrees = ((sourceRotation - rotation) % 360 + 360) % 360;
+    return degrees > 180 ? degrees - 360 : degrees;
+}
+
+QImage RotateDialog::transformed(const QImage &image, int rotation, bool flipHorizontal, bool flipVertical)
+{
+    // Rotation first, then the flips, in display space like the display matrix
+    QImage result = rotation != 0 ? image.transformed(QTransform().rotate(rotation)) : image;
+    if (flipHorizontal || flipVertical)
+        result = result.mirrored(flipHorizontal, flipVertical);
+    return result;
+}
+
+void RotateDialog::updatePreview()
+{
+    if (still.isNull())
+        return;
+
+    QImage image = transformed(still, getRotation(), getFlipHorizontal(), getFlipVertical());
+    previewLabel->setPixmap(QPixmap::fromImage(image));
+}
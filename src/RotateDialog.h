@@ -0,0 +1,64 @@
+#ifndef ROTATEDIALOG_H
+#define ROTATEDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include <QImage>
+#include "MediaProbe.h"
+
+class QProcess;
+
+class RotateDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    RotateDialog(const QString &videoFile, const MediaInfo &info, double previewSeconds,
+                 QWidget *parent = nullptr);
+
+    // Degrees clockwise: 0, 90, 180 or 270
+    int getRotation() const;
+    bool getFlipHorizontal() const;
+    bool getFlipVertical() const;
+    QStringList getFFMPEGArguments(const QString &outputFile) const;
+
+    // -display_rotation and the flip options arrived in ffmpeg 6.0
+    static bool hasDisplayMatrixOptions();
+
+    // MP4 and MOV carry a display matrix, so the frames can be stream-copied
+    static bool canRotateLosslessly(const QString &outputFile);
+
+    // The transform is written as the input's display matrix. Under stream copy only the
+    // container header changes; for other containers ffmpeg's autorotate applies the same
+    // matrix while re-encoding, so both paths give the same picture. Without the options
+    // (ffmpeg before 6.0) it re-encodes through transpose/hflip/vflip instead
+    static QStringList buildArguments(const QString &videoFile, int sourceRotation, int rotation,
+                                      bool flipHorizontal, bool flipVertical, const QString &outputFile);
+
+    // Counter-clockwise display rotation after turning the picture `rotation` degrees
+    // clockwise, normalized to -180..180 as ffprobe reports it
+    static int displayRotation(int sourceRotation, int rotation);
+
+    // The same transform applied to a still as it is displayed now
+    static QImage transformed(const QImage &image, int rotation, bool flipHorizontal, bool flipVertical);
+
+private slots:
+    void updatePreview();
+
+private:
+    QString videoFile;
+    MediaInfo info;
+
+    QComboBox *rotationCombo;
+    QCheckBox *flipHorizontalCheckbox;
+    QCheckBox *flipVerticalCheckbox;
+    QLabel *previewLabel;
+    QLabel *methodLabel;
+    QImage still; // Source frame at the playhead, already in its current orientation
+};
+
+#endif // ROTATEDIALOG_H
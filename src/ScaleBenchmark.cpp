@@ -0,0 +1,119 @@
+#include "ScaleBenchmark.h"
+#include "FFmpegCapabilities.h"
+#include <QProcess>
+
+ScaleBenchmark::ScaleBenchmark(QObject *parent)
+    : QObject(parent), process(nullptr), threads(0), baselineSeconds(0)
+{
+}
+
+ScaleBenchmark::~ScaleBenchmark()
+{
+    cancel();
+}
+
+QString ScaleBenchmark::scaleFilter(int width, int height, const QString &algorithm, int threads)
+{
+    QString filter = QString("scale=%1:%2:flags=%3").arg(width).arg(height).arg(algorithm);
+
+    // Slice threading inside swscale; without it one core scales every frame.
+    // ffmpeg before 5.0 rejects the option, and -filter_threads still applies there
+    if (threads > 0 && FFmpegCapabilities::instance().hasFilterOption("scale", "threads"))
+        filter += QString(":threads=%1").arg(threads);
+    return filter;
+}
+
+QStringList ScaleBenchmark::threadArguments(int threads, bool complexGraph)
+{
+    if (threads <= 0)
+        return QStringList();
+    return QStringList() << (complexGraph ? "-filter_complex_threads" : "-filter_threads")
+                         << QString::number(threads);
+}
+
+void ScaleBenchmark::start(const QSize &sourceSize, const QSize &targetSize,
+                           const QStringList &algorithms, int threadCount)
+{
+    cancel();
+    source = sourceSize;
+    target = targetSize;
+    threads = threadCount;
+    baselineSeconds = 0;
+
+    pending = QStringList() << QString() << algorithms;
+    runNext();
+}
+
+void ScaleBenchmark::cancel()
+{
+    if (process)
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+        process = nullptr;
+    }
+    pending.clear();
+}
+
+bool ScaleBenchmark::isRunning() const
+{
+    return process != nullptr;
+}
+
+void ScaleBenchmark::runNext()
+{
+    if (pending.isEmpty())
+    {
+        emit finished();
+        return;
+    }
+    current = pending.takeFirst();
+
+    // Generated frames in the usual decoded format, so the scaler sees what a real decode gives it
+    QString filter = "format=yuv420p";
+    if (!current.isEmpty())
+        filter += "," + scaleFilter(target.width(), target.height(), current, threads);
+
+    QStringList args;
+    args << "-hide_banner" << "-v" << "error"
+         << threadArguments(threads)
+         << "-f" << "lavfi"
+         << "-i" << QString("testsrc2=size=%1x%2:rate=25").arg(source.width()).arg(source.height())
+         << "-frames:v" << QString::number(frameCount)
+         << "-vf" << filter
+         << "-f" << "null" << "-";
+
+    process = new QProcess(this);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                double seconds = timer.elapsed() / 1000.0;
+                QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+                process->deleteLater();
+                process = nullptr;
+
+                if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+                {
+                    pending.clear();
+                    emit failed(error.isEmpty() ? "Benchmark run failed" : error);
+                    return;
+                }
+
+                if (current.isEmpty())
+                {
+                    baselineSeconds = seconds;
+                }
+                else
+                {
+                    // Frame generation and process startup are in the baseline
+                    double scaling = qMax(seconds - baselineSeconds, 0.001);
+                    double megapixels = double(source.width()) * source.height() * frameCount / 1e6;
+                    emit measured(current, megapixels / scaling);
+                }
+                runNext();
+            });
+
+    timer.start();
+    process->start("ffmpeg", args);
+}
@@ -0,0 +1,53 @@
+#ifndef SCALEBENCHMARK_H
+#define SCALEBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QSize>
+#include <QElapsedTimer>
+
+class QProcess;
+
+// Measures each scaling algorithm's throughput on this machine for a given
+// source and target size. Synthetic frames are scaled into a null sink one
+// algorithm at a time so runs don't compete for cores, and a pass without the
+// scaler is subtracted so only the scaling cost is reported.
+class ScaleBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScaleBenchmark(QObject *parent = nullptr);
+    ~ScaleBenchmark();
+
+    void start(const QSize &source, const QSize &target, const QStringList &algorithms, int threads);
+    void cancel();
+    bool isRunning() const;
+
+    // Arguments shared with real jobs: slice-threaded swscale plus filtergraph threads
+    static QString scaleFilter(int width, int height, const QString &algorithm, int threads);
+    static QStringList threadArguments(int threads, bool complexGraph = false);
+
+signals:
+    // Source megapixels scaled per second
+    void measured(const QString &algorithm, double megapixelsPerSecond);
+    void finished();
+    void failed(const QString &error);
+
+private:
+    static const int frameCount = 60;
+
+    void runNext();
+
+    QProcess *process;
+    QStringList pending; // Algorithms still to run; the baseline has an empty name
+    QString current;
+    QSize source;
+    QSize target;
+    int threads;
+    double baselineSeconds;
+    QElapsedTimer timer;
+};
+
+#endif // SCALEBENCHMARK_H
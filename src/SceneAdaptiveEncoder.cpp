@@ -0,0 +1,410 @@
+#include "SceneAdaptiveEncoder.h"
+#include "FFmpegPipeline.h"
+#include "FFmpegArguments.h"
+#include "FFmpegLog.h"
+#include "MediaProbe.h"
+#include "QualityVerifier.h"
+#include <QProcess>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QThread>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    const double sceneThreshold = 0.35; // ffmpeg's scene score, 0..1
+    const double minSceneSeconds = 2.0; // Shorter scenes are merged into the previous one
+    const double maxSceneSeconds = 20.0; // Longer ones are split, which also keeps every core busy
+    const double sampleSeconds = 2.0;   // Analysed from the middle of each scene
+    const int probeHeight = 270;
+
+    // SSIM as decibels, where equal steps are roughly equal CRF steps
+    double ssimDb(double ssim)
+    {
+        return -10.0 * std::log10(qMax(1e-6, 1.0 - ssim));
+    }
+}
+
+SceneAdaptiveEncoder::SceneAdaptiveEncoder(FFmpegLog *log, QObject *parent)
+    : QObject(parent), log(log), detector(nullptr), pipeline(nullptr), workDir(nullptr),
+      duration(0), frameRate(0), targetSsim(0.97)
+{
+    probeCrfs[0] = probeCrfs[1] = 0;
+}
+
+SceneAdaptiveEncoder::~SceneAdaptiveEncoder()
+{
+    cancel();
+}
+
+bool SceneAdaptiveEncoder::isSupported(const QString &videoEncoder)
+{
+    return videoEncoder == "libx264" || videoEncoder == "libx265" || videoEncoder == "libvpx-vp9";
+}
+
+void SceneAdaptiveEncoder::start(const QStringList &args, const QString &output, double durationSeconds,
+                                 double target)
+{
+    cancel();
+
+    arguments = args;
+    outputFile = output;
+    duration = durationSeconds;
+    targetSsim = target;
+    encoder = FFmpegArguments::optionValue(args, "-c:v");
+    sourceFile = FFmpegArguments::optionValue(args, "-i");
+    frameRate = MediaProbe::frameRateValue(MediaProbe::probe(sourceFile).frameRate);
+    scenes.clear();
+
+    // Brackets the useful range of each encoder, so the target is interpolated rather than extrapolated
+    if (encoder == "libvpx-vp9")
+    {
+        probeCrfs[0] = 24;
+        probeCrfs[1] = 44;
+    }
+    else
+    {
+        probeCrfs[0] = encoder == "libx265" ? 20 : 18;
+        probeCrfs[1] = probeCrfs[0] + 12;
+    }
+
+    workDir = new QTemporaryDir();
+
+    // The scene score only needs a thumbnail-sized picture
+    QStringList detectArgs;
+    detectArgs << "-hide_banner" << "-nostats"
+               << "-i" << sourceFile
+               << "-an" << "-sn"
+               << "-vf" << QString("scale=-2:180,select='gt(scene,%1)',showinfo").arg(sceneThreshold)
+               << "-f" << "null" << "-";
+
+    detector = new QProcess(this);
+    connect(detector, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus)
+            { detectionFinished(exitCode); });
+
+    // finished is never emitted when ffmpeg can't be started at all; report it from the event loop
+    connect(detector, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error)
+            {
+                if (error != QProcess::FailedToStart)
+                    return;
+                QString message = "Could not start ffmpeg: " + detector->errorString();
+                detector->deleteLater();
+                detector = nullptr;
+                QMetaObject::invokeMethod(this, [this, message]()
+                                          { emit finished(false, message); }, Qt::QueuedConnection);
+            });
+    log->trackStart(detector);
+
+    emit progress("Detecting scenes...");
+    detector->start("ffmpeg", detectArgs);
+}
+
+void SceneAdaptiveEncoder::cancel()
+{
+    if (detector)
+    {
+        detector->disconnect(this);
+        detector->kill();
+        detector->waitForFinished(1000);
+        delete detector;
+        detector = nullptr;
+    }
+
+    delete pipeline;
+    pipeline = nullptr;
+    delete workDir;
+    workDir = nullptr;
+}
+
+QString SceneAdaptiveEncoder::summary() const
+{
+    if (scenes.isEmpty())
+        return QString();
+
+    double low = scenes.first().crf;
+    double high = low;
+    for (const Scene &scene : scenes)
+    {
+        low = qMin(low, scene.crf);
+        high = qMax(high, scene.crf);
+    }
+    return QString("%1 scenes, CRF %2 to %3").arg(scenes.size()).arg(low, 0, 'f', 1).arg(high, 0, 'f', 1);
+}
+
+void SceneAdaptiveEncoder::detectionFinished(int exitCode)
+{
+    QString output = QString::fromUtf8(detector->readAllStandardError());
+    detector->deleteLater();
+    detector = nullptr;
+
+    if (exitCode != 0)
+    {
+        QStringList lines = output.trimmed().split('\n');
+        emit finished(false, "Scene detection failed: " + lines.last());
+        return;
+    }
+
+    // showinfo prints one line per frame that passed the select, i.e. per cut
+    QVector<double> cuts;
+    static const QRegularExpression ptsTime("Parsed_showinfo.*pts_time:\\s*([0-9.]+)");
+    QRegularExpressionMatchIterator it = ptsTime.globalMatch(output);
+    while (it.hasNext())
+        cuts.append(it.next().captured(1).toDouble());
+
+    buildScenes(cuts);
+    analyseScenes();
+}
+
+void SceneAdaptiveEncoder::buildScenes(QVector<double> cuts)
+{
+    std::sort(cuts.begin(), cuts.end());
+    cuts.append(duration);
+
+    double start = 0;
+    for (double cut : cuts)
+    {
+        if (cut - start < minSceneSeconds && cut < duration)
+            continue;
+
+        // Very short tail: fold it into the last scene
+        if (cut - start < minSceneSeconds && !scenes.isEmpty())
+        {
+            scenes.last().end = cut;
+            start = cut;
+            continue;
+        }
+
+        int pieces = qMax(1, int(std::ceil((cut - start) / maxSceneSeconds)));
+        double length = (cut - start) / pieces;
+        for (int i = 0; i < pieces; ++i)
+        {
+            Scene scene;
+            scene.start = start + i * length;
+            scene.end = i == pieces - 1 ? cut : start + (i + 1) * length;
+            scene.crf = probeCrfs[0];
+            scene.ssim[0] = scene.ssim[1] = 0;
+            scenes.append(scene);
+        }
+        start = cut;
+    }
+
+    // Every part must start on the same frame the previous one stopped before
+    for (int i = 1; i < scenes.size(); ++i)
+    {
+        scenes[i].start = frameBoundary(scenes[i].start);
+        scenes[i - 1].end = scenes[i].start;
+    }
+}
+
+double SceneAdaptiveEncoder::frameBoundary(double seconds) const
+{
+    // Halfway between two frames, so the millisecond rounding of -ss/-t can't move a frame across it
+    if (frameRate <= 0 || seconds <= 0)
+        return seconds;
+    return (std::round(seconds * frameRate) - 0.5) / frameRate;
+}
+
+QString SceneAdaptiveEncoder::probeFile(int scene, int probe) const
+{
+    return workDir->path() + QString("/probe%1_%2.mkv").arg(scene, 4, 10, QChar('0')).arg(probe);
+}
+
+QString SceneAdaptiveEncoder::statsFile(int scene, int probe) const
+{
+    return workDir->path() + QString("/ssim%1_%2.log").arg(scene, 4, 10, QChar('0')).arg(probe);
+}
+
+void SceneAdaptiveEncoder::analyseScenes()
+{
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName() + " (analysis)", this);
+    pipeline->setMaxParallel(QThread::idealThreadCount());
+
+    QString scale = QString("scale=-2:%1").arg(probeHeight);
+
+    // Small single-threaded encodes, as many at once as there are cores
+    for (int i = 0; i < scenes.size(); ++i)
+    {
+        const Scene &scene = scenes[i];
+        double length = qMin(sampleSeconds, scene.end - scene.start);
+        double start = (scene.start + scene.end - length) / 2;
+
+        for (int probe = 0; probe < 2; ++probe)
+        {
+            QStringList args;
+            args << "-y"
+                 << "-ss" << QString::number(start, 'f', 3) << "-t" << QString::number(length, 'f', 3)
+                 << "-i" << sourceFile
+                 << "-an" << "-sn"
+                 << "-vf" << scale
+                 << "-c:v" << encoder
+                 << "-crf" << QString::number(probeCrfs[probe])
+                 << "-threads" << "1";
+            if (encoder == "libvpx-vp9")
+                args << "-b:v" << "0" << "-deadline" << "realtime" << "-cpu-used" << "8";
+            else
+                args << "-preset" << "veryfast";
+            args << probeFile(i, probe);
+            pipeline->addStep(args);
+        }
+    }
+    pipeline->addBarrier();
+
+    // Compare each test encode with the same scaled window of the source
+    for (int i = 0; i < scenes.size(); ++i)
+    {
+        const Scene &scene = scenes[i];
+        double length = qMin(sampleSeconds, scene.end - scene.start);
+        double start = (scene.start + scene.end - length) / 2;
+
+        for (int probe = 0; probe < 2; ++probe)
+        {
+            pipeline->addStep(QStringList()
+                              << "-i" << probeFile(i, probe)
+                              << "-ss" << QString::number(start, 'f', 3) << "-t" << QString::number(length, 'f', 3)
+                              << "-i" << sourceFile
+                              << "-lavfi" << QString("[1:v]%1[ref];[0:v][ref]ssim=stats_file=%2")
+                                                 .arg(scale)
+                                                 .arg(FFmpegArguments::filterPath(statsFile(i, probe)))
+                              << "-f" << "null" << "-");
+        }
+    }
+
+    connect(pipeline, &FFmpegPipeline::progress, this, [this](int completed, int total)
+            { emit progress(QString("Analysing %1 scenes... %2%").arg(scenes.size()).arg(100 * completed / total)); });
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+                if (!success)
+                {
+                    emit finished(false, error);
+                    return;
+                }
+                chooseCrfs();
+                encodeScenes();
+            });
+
+    emit progress(QString("Analysing %1 scenes...").arg(scenes.size()));
+    pipeline->start();
+}
+
+void SceneAdaptiveEncoder::chooseCrfs()
+{
+    double target = ssimDb(targetSsim);
+    bool integerCrf = encoder == "libvpx-vp9";
+
+    for (int i = 0; i < scenes.size(); ++i)
+    {
+        Scene &scene = scenes[i];
+        scene.ssim[0] = QualityVerifier::averageSsim(statsFile(i, 0));
+        scene.ssim[1] = QualityVerifier::averageSsim(statsFile(i, 1));
+
+        // Quality in dB falls about linearly with CRF; solve for the target on that line
+        double low = ssimDb(scene.ssim[0]);
+        double high = ssimDb(scene.ssim[1]);
+        double crf;
+        if (scene.ssim[0] <= 0 || scene.ssim[1] <= 0 || low - high < 0.01)
+            crf = (probeCrfs[0] + probeCrfs[1]) / 2; // Flat or unreadable: take the middle
+        else
+            crf = probeCrfs[0] + (low - target) * (probeCrfs[1] - probeCrfs[0]) / (low - high);
+
+        crf = qBound(probeCrfs[0] - 4, crf, probeCrfs[1] + 6);
+        scene.crf = integerCrf ? std::round(crf) : std::round(crf * 10) / 10;
+    }
+}
+
+void SceneAdaptiveEncoder::encodeScenes()
+{
+    // A few encoders side by side, each with its share of the cores; scene
+    // encodes parallelise better than the threads inside one encoder do
+    int cores = QThread::idealThreadCount();
+    int parallel = qBound(2, cores / 4, qMax(2, int(scenes.size())));
+    int threads = qMax(1, cores / parallel);
+
+    QString listFile = workDir->path() + "/scenes.txt";
+    QFile list(listFile);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        emit finished(false, "Could not write the scene list");
+        return;
+    }
+    QTextStream stream(&list);
+
+    pipeline = new FFmpegPipeline(log, QFileInfo(outputFile).fileName(), this);
+    pipeline->setMaxParallel(parallel);
+
+    // Video only; every scene starts with a keyframe, so the parts join cleanly
+    QStringList videoArgs = arguments;
+    videoArgs.removeAll("-an");
+    for (const QString &option : {QString("-c:a"), QString("-b:a")})
+    {
+        int index = videoArgs.indexOf(option);
+        if (index >= 0)
+            videoArgs.erase(videoArgs.begin() + index, videoArgs.begin() + index + 2);
+    }
+    videoArgs.insert(videoArgs.size() - 1, "-an");
+
+    for (int i = 0; i < scenes.size(); ++i)
+    {
+        const Scene &scene = scenes[i];
+        QString part = workDir->path() + QString("/scene%1.mkv").arg(i, 4, 10, QChar('0'));
+
+        QStringList args = FFmpegArguments::withOutputFile(videoArgs, part);
+        args = FFmpegArguments::withInputWindow(args, scene.start, scene.end - scene.start);
+        args = FFmpegArguments::withOption(args, "-crf", QString::number(scene.crf));
+        args = FFmpegArguments::withOption(args, "-threads", QString::number(threads));
+
+        // Per-scene CRFs would otherwise change the parameter sets mid-stream, which the copy-join keeps only once
+        if (encoder == "libx264" || encoder == "libx265")
+        {
+            QString option = encoder == "libx264" ? "-x264-params" : "-x265-params";
+            QString setting = encoder == "libx264" ? "stitchable=1" : "repeat-headers=1";
+            QString params = FFmpegArguments::optionValue(args, option);
+            args = FFmpegArguments::withOption(args, option, params.isEmpty() ? setting : params + ":" + setting);
+        }
+        pipeline->addStep(args);
+
+        stream << "file '" << QString(part).replace("'", "'\\''") << "'\n";
+    }
+    list.close();
+    pipeline->addBarrier();
+
+    // Audio straight from the source, with the settings of the original command
+    QStringList joinArgs;
+    joinArgs << "-y"
+             << "-f" << "concat" << "-safe" << "0" << "-i" << listFile
+             << "-i" << sourceFile
+             << "-map" << "0:v" << "-map" << "1:a?"
+             << "-c:v" << "copy";
+    if (arguments.contains("-an"))
+        joinArgs << "-an";
+    else
+        joinArgs << "-c:a" << FFmpegArguments::optionValue(arguments, "-c:a")
+                 << "-b:a" << FFmpegArguments::optionValue(arguments, "-b:a");
+    joinArgs << outputFile;
+    pipeline->addStep(joinArgs);
+
+    connect(pipeline, &FFmpegPipeline::progress, this, [this](int completed, int total)
+            {
+        if (completed < scenes.size())
+            emit progress(QString("Encoding scenes: %1 of %2").arg(completed).arg(scenes.size()));
+        else
+            emit progress("Joining scenes..."); });
+    connect(pipeline, &FFmpegPipeline::finished, this,
+            [this](bool success, const QString &error)
+            {
+                pipeline->deleteLater();
+                pipeline = nullptr;
+                delete workDir;
+                workDir = nullptr;
+                emit finished(success, error);
+            });
+
+    emit progress(QString("Encoding scenes: 0 of %1").arg(scenes.size()));
+    pipeline->start();
+}
@@ -0,0 +1,79 @@
+#ifndef SCENEADAPTIVEENCODER_H
+#define SCENEADAPTIVEENCODER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QTemporaryDir>
+
+class QProcess;
+class FFmpegLog;
+class FFmpegPipeline;
+
+// Content-adaptive constant-quality encode. Scene cuts are detected on a small
+// decode, each scene is test-encoded at low resolution at two CRFs and compared
+// with the source (SSIM), and the CRF that meets the quality target is used for
+// that scene. Scenes are then encoded in parallel and joined by stream copy,
+// with the audio taken once from the source.
+class SceneAdaptiveEncoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    SceneAdaptiveEncoder(FFmpegLog *log, QObject *parent = nullptr);
+    ~SceneAdaptiveEncoder();
+
+    // Encoders with a CRF mode; the others have nothing to adapt
+    static bool isSupported(const QString &videoEncoder);
+
+    // arguments is the complete single-file command ending in outputFile, with a -crf
+    // to be replaced per scene; targetSsim is measured against the source
+    void start(const QStringList &arguments, const QString &outputFile, double durationSeconds,
+               double targetSsim);
+    void cancel();
+
+    // e.g. "14 scenes, CRF 19.0 to 27.5", once finished
+    QString summary() const;
+
+signals:
+    void progress(const QString &status);
+    void finished(bool success, const QString &error);
+
+private:
+    struct Scene
+    {
+        double start;
+        double end;
+        double crf;
+        double ssim[2]; // At the two probe CRFs
+    };
+
+    void detectionFinished(int exitCode);
+    void buildScenes(QVector<double> cuts);
+    void analyseScenes();
+    void chooseCrfs();
+    void encodeScenes();
+
+    QString probeFile(int scene, int probe) const;
+    QString statsFile(int scene, int probe) const;
+    double frameBoundary(double seconds) const;
+
+    FFmpegLog *log;
+    QProcess *detector;
+    FFmpegPipeline *pipeline;
+    QTemporaryDir *workDir;
+
+    QStringList arguments;
+    QString outputFile;
+    QString encoder;
+    QString sourceFile;
+    double duration;
+    double frameRate; // Of the source, 0 if unknown
+    double targetSsim;
+    double probeCrfs[2];
+    QList<Scene> scenes;
+};
+
+#endif // SCENEADAPTIVEENCODER_H
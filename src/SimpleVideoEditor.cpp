@@ -3,6 +3,27 @@
 #include "CropDialog.h"
 #include "ResizeDialog.h"
 #include "ConvertDialog.h"
+#include "JoinDialog.h"
+#include "SpeedDialog.h"
+#include "RotateDialog.h"
+#include "AudioDialog.h"
+#include "FFmpegLog.h"
+#include "LogViewerDialog.h"
+#include "AudioPeaks.h"
+#include "WaveformWidget.h"
+#include "KeepRangesWidget.h"
+#include "MultiCutExporter.h"
+#include "MediaProbe.h"
+#include "InputPrefetcher.h"
+#include "FFmpegPipeline.h"
+#include "PlaybackMetrics.h"
+#include "PlaybackMetricsDialog.h"
+#include "PacketAnalyzerDialog.h"
+#include "ExportPreview.h"
+#include "ImageSequenceDialog.h"
+#include "ImageSequenceExporter.h"
+#include "QualityVerifier.h"
+#include "FFmpegArguments.h"
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QUrl>
@@ -13,8 +34,22 @@
 #include <QMenuBar>
 #include <QStatusBar>
 #include <QApplication>
-
-SimpleVideoEditor::SimpleVideoEditor(QWidget *parent) : QMainWindow(parent)
+#include <QFileInfo>
+#include <QKeySequence>
+#include <QTemporaryDir>
+#include <QMediaMetaData>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+
+SimpleVideoEditor::SimpleVideoEditor(QWidget *parent)
+    : QMainWindow(parent), ffmpegLog(new FFmpegLog(2000, this)), logViewer(nullptr),
+      multiCutExporter(nullptr), prefetcher(new InputPrefetcher(this)),
+      playbackMetrics(new PlaybackMetrics(this)), playbackMetricsDialog(nullptr),
+      packetAnalyzerDialog(nullptr), exportPreview(nullptr), imageSequenceExporter(new ImageSequenceExporter(this)),
+      verifyQualityAction(nullptr), awaitingDuration(false)
 {
     setWindowTitle("Simple Video Editor");
     resize(1024, 768);
@@ -33,6 +68,38 @@ SimpleVideoEditor::SimpleVideoEditor(QWidget *parent) : QMainWindow(parent)
     mediaPlayer->setVideoOutput(videoWidget);
     mainLayout->addWidget(videoWidget);
 
+    // Settings previews from the export dialogs play here
+    exportPreview = new ExportPreview(mediaPlayer, ffmpegLog, this);
+    connect(exportPreview, &ExportPreview::ready, [this]()
+            { playButton->setText("Pause"); });
+
+    // Stay ahead of every export's reads of the loaded file, whichever path started it.
+    // A job that seeks its input (-ss before -i) doesn't read from the start, so its
+    // read count says nothing about its position in the file
+    connect(ffmpegLog, &FFmpegLog::processStarted, [this](qint64 pid, const QStringList &arguments)
+            {
+        int input = arguments.indexOf(currentVideoFile);
+        if (currentVideoFile.isEmpty() || input < 1 || arguments[input - 1] != "-i")
+            return;
+        int previousInput = input >= 2 ? arguments.lastIndexOf("-i", input - 2) : -1;
+        for (int i = previousInput + 1; i < input - 1; ++i)
+        {
+            if (arguments[i] == "-ss" || arguments[i] == "-sseof")
+                return;
+        }
+        prefetcher->followProcess(pid, currentVideoFile); });
+
+    // Background reads back off while the player is using the disk
+    connect(mediaPlayer, &QMediaPlayer::playbackStateChanged, [this](QMediaPlayer::PlaybackState state)
+            {
+        prefetcher->setPlaybackActive(state == QMediaPlayer::PlayingState);
+        playbackMetrics->restartSchedule(); });
+
+    // Pacing is judged against the stream's own frame rate
+    connect(mediaPlayer, &QMediaPlayer::metaDataChanged, [this]()
+            { playbackMetrics->setNominalFrameRate(mediaPlayer->metaData().value(QMediaMetaData::VideoFrameRate).toDouble()); });
+    connect(mediaPlayer, &QMediaPlayer::playbackRateChanged, playbackMetrics, &PlaybackMetrics::setPlaybackRate);
+
     // Timeline and controls
     QHBoxLayout *timelineLayout = new QHBoxLayout();
 
@@ -51,17 +118,57 @@ SimpleVideoEditor::SimpleVideoEditor(QWidget *parent) : QMainWindow(parent)
     timelineSlider->setMinimum(0);
     timelineSlider->setMaximum(100);
 
+    // Audio waveform under the slider, aligned with it
+    audioPeaks = new AudioPeaks(this);
+    waveformWidget = new WaveformWidget(audioPeaks, this);
+
+    // Ranges kept by a multi-range cut, marked with Mark In / Mark Out
+    rangesWidget = new KeepRangesWidget(this);
+
     connect(mediaPlayer, &QMediaPlayer::durationChanged, [this](qint64 duration)
-            { timelineSlider->setMaximum(duration); });
+            {
+        timelineSlider->setMaximum(duration);
+
+        // Only a newly loaded video resets the ranges and waveform zoom, not a preview or its restore
+        if (!awaitingDuration || duration <= 0)
+            return;
+        awaitingDuration = false;
+        waveformWidget->setDuration(duration);
+        rangesWidget->setDuration(duration); });
 
     connect(mediaPlayer, &QMediaPlayer::positionChanged, [this](qint64 position)
-            { timelineSlider->setValue(position); });
+            {
+        // Timed only while the metrics window is open
+        QElapsedTimer handlerTimer;
+        if (playbackMetrics->isAttached())
+            handlerTimer.start();
+
+        timelineSlider->setValue(position);
+        waveformWidget->setPosition(position);
+        rangesWidget->setPosition(position);
+        if (packetAnalyzerDialog && packetAnalyzerDialog->isVisible())
+            packetAnalyzerDialog->setPlayhead(position / 1000.0);
+
+        if (handlerTimer.isValid())
+            playbackMetrics->recordPositionUpdate(handlerTimer.nsecsElapsed()); });
 
     connect(timelineSlider, &QSlider::sliderMoved, [this](int position)
-            { mediaPlayer->setPosition(position); });
+            {
+        playbackMetrics->restartSchedule();
+        mediaPlayer->setPosition(position); });
 
-    timelineLayout->addWidget(playButton);
-    timelineLayout->addWidget(timelineSlider);
+    connect(waveformWidget, &WaveformWidget::seekRequested, [this](qint64 position)
+            {
+        playbackMetrics->restartSchedule();
+        mediaPlayer->setPosition(position); });
+
+    QVBoxLayout *timelineColumn = new QVBoxLayout();
+    timelineColumn->addWidget(timelineSlider);
+    timelineColumn->addWidget(waveformWidget);
+    timelineColumn->addWidget(rangesWidget);
+
+    timelineLayout->addWidget(playButton, 0, Qt::AlignTop);
+    timelineLayout->addLayout(timelineColumn);
     mainLayout->addLayout(timelineLayout);
 
     // Editing tools
@@ -71,19 +178,56 @@ SimpleVideoEditor::SimpleVideoEditor(QWidget *parent) : QMainWindow(parent)
     QPushButton *cropButton = new QPushButton("Crop", this);
     QPushButton *resizeButton = new QPushButton("Resize", this);
     QPushButton *convertButton = new QPushButton("Convert", this);
+    QPushButton *speedButton = new QPushButton("Speed", this);
+    QPushButton *rotateButton = new QPushButton("Rotate", this);
+    QPushButton *audioButton = new QPushButton("Audio", this);
+    QPushButton *joinButton = new QPushButton("Join", this);
+    QPushButton *markInButton = new QPushButton("Mark In", this);
+    QPushButton *markOutButton = new QPushButton("Mark Out", this);
+    QPushButton *exportRangesButton = new QPushButton("Export Ranges", this);
 
     // Connect editing tool buttons
     connect(trimButton, &QPushButton::clicked, this, &SimpleVideoEditor::trimVideo);
     connect(cropButton, &QPushButton::clicked, this, &SimpleVideoEditor::cropVideo);
     connect(resizeButton, &QPushButton::clicked, this, &SimpleVideoEditor::resizeVideo);
     connect(convertButton, &QPushButton::clicked, this, &SimpleVideoEditor::convertVideo);
+    connect(speedButton, &QPushButton::clicked, this, &SimpleVideoEditor::changeSpeed);
+    connect(rotateButton, &QPushButton::clicked, this, &SimpleVideoEditor::rotateVideo);
+    connect(audioButton, &QPushButton::clicked, this, &SimpleVideoEditor::editAudio);
+    connect(joinButton, &QPushButton::clicked, this, &SimpleVideoEditor::joinVideos);
+    connect(markInButton, &QPushButton::clicked, this, &SimpleVideoEditor::markIn);
+    connect(markOutButton, &QPushButton::clicked, this, &SimpleVideoEditor::markOut);
+    connect(exportRangesButton, &QPushButton::clicked, this, &SimpleVideoEditor::exportKeptRanges);
 
     toolsLayout->addWidget(trimButton);
     toolsLayout->addWidget(cropButton);
     toolsLayout->addWidget(resizeButton);
     toolsLayout->addWidget(convertButton);
+    toolsLayout->addWidget(speedButton);
+    toolsLayout->addWidget(rotateButton);
+    toolsLayout->addWidget(audioButton);
+    toolsLayout->addWidget(joinButton);
+    toolsLayout->addSpacing(16);
+    toolsLayout->addWidget(markInButton);
+    toolsLayout->addWidget(markOutButton);
+    toolsLayout->addWidget(exportRangesButton);
     mainLayout->addLayout(toolsLayout);
 
+    connect(imageSequenceExporter, &ImageSequenceExporter::progress, [this](int written, int expected)
+            {
+        if (expected > 0)
+            statusBar()->showMessage(QString("Exporting frames: %1 of about %2").arg(written).arg(expected));
+        else
+            statusBar()->showMessage(QString("Exporting frames: %1").arg(written)); });
+    connect(imageSequenceExporter, &ImageSequenceExporter::finished,
+            [this](bool success, const QString &error, int written)
+            {
+                if (success)
+                    statusBar()->showMessage(QString("Exported %1 frames").arg(written));
+                else
+                    statusBar()->showMessage(QString("Frame export stopped after %1 frames: %2").arg(written).arg(error));
+            });
+
     // Status bar for feedback
     statusBar()->showMessage("Ready");
 
@@ -97,13 +241,30 @@ void SimpleVideoEditor::openFile()
 
     if (!fileName.isEmpty())
     {
-        currentVideoFile = fileName;
-        mediaPlayer->setSource(QUrl::fromLocalFile(fileName));
-        playButton->setText("Play");
+        loadVideo(fileName);
         statusBar()->showMessage("Loaded: " + fileName);
     }
 }
 
+void SimpleVideoEditor::loadVideo(const QString &fileName)
+{
+    currentVideoFile = fileName;
+
+    // Warm the index and first GOPs before the player and dialogs ask for them
+    prefetcher->prefetch(fileName);
+    playbackMetrics->reset();
+    if (playbackMetricsDialog)
+        playbackMetricsDialog->setVideoFile(fileName);
+    if (packetAnalyzerDialog && packetAnalyzerDialog->isVisible())
+        packetAnalyzerDialog->setVideoFile(fileName, 0);
+    awaitingDuration = true;
+    mediaPlayer->setSource(QUrl::fromLocalFile(fileName));
+    playButton->setText("Play");
+
+    // Peaks come from the on-disk cache when available, otherwise an audio-only decode
+    audioPeaks->load(fileName);
+}
+
 void SimpleVideoEditor::saveFile()
 {
     if (currentVideoFile.isEmpty())
@@ -125,21 +286,273 @@ void SimpleVideoEditor::saveFile()
 void SimpleVideoEditor::executeFFMPEG(const QStringList &arguments)
 {
     QProcess *ffmpeg = new QProcess(this);
-    ffmpeg->start("ffmpeg", arguments);
+
+    // Stream stderr into the bounded log instead of letting it pile up
+    ffmpegLog->attach(ffmpeg, QFileInfo(arguments.last()).fileName());
 
     connect(ffmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this, ffmpeg](int exitCode, QProcess::ExitStatus exitStatus)
+            [this, ffmpeg, arguments](int exitCode, QProcess::ExitStatus exitStatus)
             {
                 if (exitCode == 0)
                 {
                     statusBar()->showMessage("FFMPEG operation completed successfully");
+                    verifyExport(arguments);
                 }
                 else
                 {
-                    statusBar()->showMessage("FFMPEG error: " + QString(ffmpeg->readAllStandardError()));
+                    statusBar()->showMessage("FFMPEG error: " + ffmpegLog->lastError(ffmpeg) +
+                                             " (see View > FFMPEG Log)");
                 }
                 ffmpeg->deleteLater();
             });
+
+    ffmpeg->start("ffmpeg", FFmpegLog::loggingArguments() + arguments);
+}
+
+int SimpleVideoEditor::execWithPreview(QDialog &dialog)
+{
+    // Previews play in the main window; the loaded video comes back when the dialog closes
+    exportPreview->setPlayhead(mediaPlayer->position() / 1000.0);
+    int result = dialog.exec();
+    exportPreview->restore();
+    playButton->setText("Play");
+    return result;
+}
+
+void SimpleVideoEditor::verifyExport(const QStringList &arguments)
+{
+    if (!verifyQualityAction->isChecked() || !QualityVerifier::canVerify(arguments))
+        return;
+
+    QString sourceFile = FFmpegArguments::optionValue(arguments, "-i");
+    QString outputFile = arguments.last();
+    MediaInfo output = MediaProbe::probe(outputFile);
+    if (!output.hasVideo || output.duration <= 0)
+        return;
+
+    QualityVerifier *verifier = new QualityVerifier(ffmpegLog, this);
+    connect(verifier, &QualityVerifier::progress, [this](int completed, int total)
+            { statusBar()->showMessage(QString("Verifying quality... %1/%2").arg(completed).arg(total)); });
+    connect(verifier, &QualityVerifier::finished,
+            [this, verifier, sourceFile, outputFile, arguments, output](bool success, const QString &error)
+            {
+                if (!success)
+                {
+                    statusBar()->showMessage("Quality check failed: " + error + " (see View > FFMPEG Log)");
+                    verifier->deleteLater();
+                    return;
+                }
+
+                // Kept next to the export, with what produced it, for tuning profiles later
+                QualityReport report = verifier->report();
+                QJsonObject record;
+                record["source"] = sourceFile;
+                record["output"] = outputFile;
+                record["arguments"] = QJsonArray::fromStringList(arguments);
+                record["outputBytes"] = QFileInfo(outputFile).size();
+                record["durationSeconds"] = output.duration;
+                record["kbps"] = QFileInfo(outputFile).size() * 8 / 1000.0 / output.duration;
+                record["quality"] = report.toJson();
+
+                QSaveFile file(outputFile + ".quality.json");
+                if (file.open(QIODevice::WriteOnly))
+                {
+                    file.write(QJsonDocument(record).toJson());
+                    file.commit();
+                }
+
+                statusBar()->showMessage("Quality of " + QFileInfo(outputFile).fileName() + ": " + report.summary());
+                verifier->deleteLater();
+            });
+
+    verifier->start(sourceFile, 0, outputFile, output.duration, QualityVerifier::referenceFilter(arguments));
+}
+
+void SimpleVideoEditor::showLog()
+{
+    // Created on demand and kept around so reopening is instant
+    if (!logViewer)
+        logViewer = new LogViewerDialog(ffmpegLog, this);
+
+    logViewer->show();
+    logViewer->raise();
+    logViewer->activateWindow();
+}
+
+void SimpleVideoEditor::showPlaybackMetrics()
+{
+    if (!playbackMetricsDialog)
+        playbackMetricsDialog = new PlaybackMetricsDialog(playbackMetrics, videoWidget->videoSink(), this);
+
+    playbackMetricsDialog->setVideoFile(currentVideoFile);
+    playbackMetricsDialog->show();
+    playbackMetricsDialog->raise();
+    playbackMetricsDialog->activateWindow();
+}
+
+void SimpleVideoEditor::showPacketAnalyzer()
+{
+    if (!packetAnalyzerDialog)
+    {
+        packetAnalyzerDialog = new PacketAnalyzerDialog(this);
+        connect(packetAnalyzerDialog, &PacketAnalyzerDialog::seekRequested, [this](double seconds)
+                {
+            playbackMetrics->restartSchedule();
+            mediaPlayer->setPosition(qint64(seconds * 1000)); });
+    }
+
+    // Only re-analyses when the file changed since the last time it was open
+    packetAnalyzerDialog->setVideoFile(currentVideoFile, mediaPlayer->duration() / 1000.0);
+    packetAnalyzerDialog->setPlayhead(mediaPlayer->position() / 1000.0);
+    packetAnalyzerDialog->show();
+    packetAnalyzerDialog->raise();
+    packetAnalyzerDialog->activateWindow();
+}
+
+void SimpleVideoEditor::exportImageSequence()
+{
+    if (currentVideoFile.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "No video loaded to export frames from");
+        return;
+    }
+
+    if (imageSequenceExporter->isRunning())
+    {
+        QMessageBox::information(this, "Export Image Sequence", "A frame export is already running.");
+        return;
+    }
+
+    // Frame size and rate drive the raw frame layout and the frame count estimate
+    QString error;
+    MediaInfo info = MediaProbe::probe(currentVideoFile, &error);
+    if (!info.hasVideo)
+    {
+        QMessageBox::warning(this, "Warning", "Could not read the video parameters: " + error);
+        return;
+    }
+
+    ImageSequenceDialog dialog(currentVideoFile, info, this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    QString outputDir = QFileDialog::getExistingDirectory(this, "Export Frames To");
+    if (outputDir.isEmpty())
+        return;
+
+    statusBar()->showMessage("Exporting frames...");
+    imageSequenceExporter->start(dialog.getJob(outputDir));
+}
+
+void SimpleVideoEditor::joinVideos()
+{
+    // Starts from the loaded video, if any; more clips are added in the dialog
+    JoinDialog dialog(currentVideoFile, this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    QStringList inputs = dialog.getInputFiles();
+    QString extension = QFileInfo(inputs.first()).suffix();
+    QString outputFile = QFileDialog::getSaveFileName(this,
+                                                      "Save Joined Video", "", "Video Files (*." + extension + ")");
+    if (outputFile.isEmpty())
+        return;
+
+    QTemporaryDir *workDir = new QTemporaryDir();
+    if (!workDir->isValid())
+    {
+        delete workDir;
+        QMessageBox::warning(this, "Warning", "Could not create a temporary directory");
+        return;
+    }
+
+    // Parts are independent, so they are prepared side by side; the concat waits for all of them
+    QList<QStringList> steps = dialog.getJoinSteps(workDir->path(), outputFile);
+    FFmpegPipeline *pipeline = new FFmpegPipeline(ffmpegLog, QFileInfo(outputFile).fileName(), this);
+    for (int i = 0; i < steps.size() - 1; ++i)
+        pipeline->addStep(steps[i]);
+    pipeline->addBarrier();
+    pipeline->addStep(steps.last());
+    pipeline->setMaxParallel(2);
+
+    connect(pipeline, &FFmpegPipeline::progress, [this](int completed, int total)
+            { statusBar()->showMessage(QString("Joining clips: step %1 of %2").arg(completed).arg(total)); });
+    connect(pipeline, &FFmpegPipeline::finished, [this, pipeline, workDir, inputs](bool success, const QString &error)
+            {
+        if (success)
+            statusBar()->showMessage(QString("Joined %1 clips").arg(inputs.size()));
+        else
+            statusBar()->showMessage("Join failed: " + error + " (see View > FFMPEG Log)");
+        pipeline->deleteLater();
+        delete workDir; });
+
+    statusBar()->showMessage(dialog.needsReencode() ? "Joining clips (re-encoding mismatched clips)..."
+                                                    : "Joining clips by stream copy...");
+    pipeline->start();
+}
+
+void SimpleVideoEditor::markIn()
+{
+    if (currentVideoFile.isEmpty())
+        return;
+
+    rangesWidget->markIn(mediaPlayer->position());
+    statusBar()->showMessage("In point set; mark the out point to keep the range");
+}
+
+void SimpleVideoEditor::markOut()
+{
+    if (currentVideoFile.isEmpty())
+        return;
+
+    if (!rangesWidget->hasPendingIn())
+    {
+        statusBar()->showMessage("Mark an in point first");
+        return;
+    }
+    rangesWidget->markOut(mediaPlayer->position());
+    statusBar()->showMessage(QString("%1 range(s) kept").arg(rangesWidget->ranges().size()));
+}
+
+void SimpleVideoEditor::exportKeptRanges()
+{
+    if (currentVideoFile.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "No video loaded to cut");
+        return;
+    }
+
+    QList<KeepRangesWidget::Range> ranges = rangesWidget->ranges();
+    if (ranges.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "Mark at least one range to keep (Mark In, then Mark Out)");
+        return;
+    }
+
+    // Stream copy keeps the source codec, so the container stays the same too
+    QString extension = QFileInfo(currentVideoFile).suffix();
+    QString outputFile = QFileDialog::getSaveFileName(this,
+                                                      "Export Kept Ranges", "", "Video Files (*." + extension + ")");
+    if (outputFile.isEmpty())
+        return;
+    if (QFileInfo(outputFile).suffix().isEmpty())
+        outputFile += "." + extension;
+
+    if (!multiCutExporter)
+    {
+        multiCutExporter = new MultiCutExporter(ffmpegLog, this);
+        connect(multiCutExporter, &MultiCutExporter::progress, [this](int completed, int total)
+                { statusBar()->showMessage(QString("Exporting ranges: step %1 of %2").arg(completed).arg(total)); });
+        connect(multiCutExporter, &MultiCutExporter::finished, [this](bool success, const QString &message)
+                {
+            if (success)
+                statusBar()->showMessage(message);
+            else
+                statusBar()->showMessage("Range export failed: " + message + " (see View > FFMPEG Log)"); });
+    }
+
+    statusBar()->showMessage("Finding keyframes...");
+    multiCutExporter->start(currentVideoFile, ranges, outputFile);
 }
 
 void SimpleVideoEditor::trimVideo()
@@ -175,16 +588,20 @@ void SimpleVideoEditor::cropVideo()
         return;
     }
 
-    // Here we would determine the video dimensions
-    // For simplicity, assume 1280x720 if we can't get actual dimensions
-    int videoWidth = 1280;
-    int videoHeight = 720;
+    // Real dimensions and codec; the codec decides whether a lossless crop is possible
+    QString error;
+    MediaInfo info = MediaProbe::probe(currentVideoFile, &error);
+    if (!info.hasVideo)
+    {
+        QMessageBox::warning(this, "Warning", "Could not read the video dimensions: " + error);
+        return;
+    }
 
-    // In a real application, you would query the video for its dimensions
-    // This could be done with ffprobe or by using the mediaPlayer's properties
+    CropDialog dialog(currentVideoFile, info, this);
+    dialog.setExportPreview(exportPreview);
+    int result = execWithPreview(dialog);
 
-    CropDialog dialog(currentVideoFile, videoWidth, videoHeight, this);
-    if (dialog.exec() == QDialog::Accepted)
+    if (result == QDialog::Accepted)
     {
         QString outputFile = QFileDialog::getSaveFileName(this,
                                                           "Save Cropped Video", "", "Video Files (*.mp4)");
@@ -197,6 +614,109 @@ void SimpleVideoEditor::cropVideo()
     }
 }
 
+void SimpleVideoEditor::changeSpeed()
+{
+    if (currentVideoFile.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "No video loaded to speed up");
+        return;
+    }
+
+    // Frame rate sets the default output rate, duration the length estimate
+    QString error;
+    MediaInfo info = MediaProbe::probe(currentVideoFile, &error);
+    if (!info.hasVideo)
+    {
+        QMessageBox::warning(this, "Warning", "Could not read the video parameters: " + error);
+        return;
+    }
+
+    SpeedDialog dialog(currentVideoFile, info, this);
+    if (dialog.exec() == QDialog::Accepted)
+    {
+        QString outputFile = QFileDialog::getSaveFileName(this,
+                                                          "Save Sped-Up Video", "", "Video Files (*.mp4)");
+
+        if (!outputFile.isEmpty())
+        {
+            QStringList args = dialog.getFFMPEGArguments(outputFile);
+            executeFFMPEG(args);
+        }
+    }
+}
+
+void SimpleVideoEditor::rotateVideo()
+{
+    if (currentVideoFile.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "No video loaded to rotate");
+        return;
+    }
+
+    // The current display rotation, which the new one is relative to
+    QString error;
+    MediaInfo info = MediaProbe::probe(currentVideoFile, &error);
+    if (!info.hasVideo)
+    {
+        QMessageBox::warning(this, "Warning", "Could not read the video parameters: " + error);
+        return;
+    }
+
+    RotateDialog dialog(currentVideoFile, info, mediaPlayer->position() / 1000.0, this);
+    if (dialog.exec() == QDialog::Accepted)
+    {
+        // Keeping the source's container keeps the rotation lossless where that is possible
+        QString suffix = QFileInfo(currentVideoFile).suffix().toLower();
+        QString filter = "Video Files (*." + (suffix.isEmpty() ? QString("mp4") : suffix) + ")";
+        QString outputFile = QFileDialog::getSaveFileName(this,
+                                                          "Save Rotated Video", "", filter + ";;MP4 Files (*.mp4)");
+
+        if (!outputFile.isEmpty())
+        {
+            QStringList args = dialog.getFFMPEGArguments(outputFile);
+            statusBar()->showMessage(RotateDialog::canRotateLosslessly(outputFile)
+                                         ? "Rotating video (no re-encode)..."
+                                         : "Rotating video (re-encoding)...");
+            executeFFMPEG(args);
+        }
+    }
+}
+
+void SimpleVideoEditor::editAudio()
+{
+    if (currentVideoFile.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "No video loaded to edit");
+        return;
+    }
+
+    // Whether there is a track to process, and its sample rate
+    QString error;
+    MediaInfo info = MediaProbe::probe(currentVideoFile, &error);
+    if (!info.hasVideo)
+    {
+        QMessageBox::warning(this, "Warning", "Could not read the video parameters: " + error);
+        return;
+    }
+
+    AudioDialog dialog(currentVideoFile, info, this);
+    if (dialog.exec() == QDialog::Accepted)
+    {
+        // The copied video stream has to fit the container, so the source's is the safe default
+        QString suffix = QFileInfo(currentVideoFile).suffix().toLower();
+        QString filter = "Video Files (*." + (suffix.isEmpty() ? QString("mp4") : suffix) + ")";
+        QString outputFile = QFileDialog::getSaveFileName(this,
+                                                          "Save Video", "", filter + ";;All Files (*)");
+
+        if (!outputFile.isEmpty())
+        {
+            QStringList args = dialog.getFFMPEGArguments(outputFile);
+            statusBar()->showMessage("Processing audio (video is copied)...");
+            executeFFMPEG(args);
+        }
+    }
+}
+
 void SimpleVideoEditor::resizeVideo()
 {
     if (currentVideoFile.isEmpty())
@@ -205,19 +725,35 @@ void SimpleVideoEditor::resizeVideo()
         return;
     }
 
-    // Again, assume 1280x720 if we can't get actual dimensions
-    int videoWidth = 1280;
-    int videoHeight = 720;
+    // Real dimensions, which the scaler calibration also runs at
+    QString error;
+    MediaInfo info = MediaProbe::probe(currentVideoFile, &error);
+    if (!info.hasVideo)
+    {
+        QMessageBox::warning(this, "Warning", "Could not read the video dimensions: " + error);
+        return;
+    }
 
-    ResizeDialog dialog(currentVideoFile, videoWidth, videoHeight, this);
-    if (dialog.exec() == QDialog::Accepted)
+    ResizeDialog dialog(currentVideoFile, info.width, info.height, this);
+    dialog.setExportPreview(exportPreview);
+    int result = execWithPreview(dialog);
+
+    if (result == QDialog::Accepted)
     {
+        if (dialog.isLadderExport() && dialog.getLadderSizes().isEmpty())
+        {
+            QMessageBox::warning(this, "Warning", "Select at least one ladder size");
+            return;
+        }
+
         QString outputFile = QFileDialog::getSaveFileName(this,
                                                           "Save Resized Video", "", "Video Files (*.mp4)");
 
         if (!outputFile.isEmpty())
         {
-            QStringList args = dialog.getFFMPEGArguments(outputFile);
+            // A ladder writes one file per size, named after the chosen file
+            QStringList args = dialog.isLadderExport() ? dialog.getLadderArguments(outputFile)
+                                                       : dialog.getFFMPEGArguments(outputFile);
             executeFFMPEG(args);
         }
     }
@@ -233,6 +769,9 @@ void SimpleVideoEditor::createMenus()
     QAction *saveAction = fileMenu->addAction("&Save");
     connect(saveAction, &QAction::triggered, this, &SimpleVideoEditor::saveFile);
 
+    QAction *imageSequenceAction = fileMenu->addAction("Export &Image Sequence...");
+    connect(imageSequenceAction, &QAction::triggered, this, &SimpleVideoEditor::exportImageSequence);
+
     fileMenu->addSeparator();
 
     QAction *exitAction = fileMenu->addAction("E&xit");
@@ -252,6 +791,53 @@ void SimpleVideoEditor::createMenus()
     QAction *convertAction = editMenu->addAction("&Convert");
     connect(convertAction, &QAction::triggered, this, &SimpleVideoEditor::convertVideo);
 
+    QAction *workersAction = editMenu->addAction("Convert on &Workers...");
+    connect(workersAction, &QAction::triggered, this, &SimpleVideoEditor::convertOnWorkers);
+
+    QAction *speedAction = editMenu->addAction("Change S&peed...");
+    connect(speedAction, &QAction::triggered, this, &SimpleVideoEditor::changeSpeed);
+
+    QAction *rotateAction = editMenu->addAction("Rotate / &Flip...");
+    connect(rotateAction, &QAction::triggered, this, &SimpleVideoEditor::rotateVideo);
+
+    QAction *audioAction = editMenu->addAction("&Audio...");
+    connect(audioAction, &QAction::triggered, this, &SimpleVideoEditor::editAudio);
+
+    QAction *joinAction = editMenu->addAction("&Join Clips...");
+    connect(joinAction, &QAction::triggered, this, &SimpleVideoEditor::joinVideos);
+
+    // Compares re-encoded exports with their source and saves the scores next to them
+    verifyQualityAction = editMenu->addAction("&Verify Quality After Export");
+    verifyQualityAction->setCheckable(true);
+
+    editMenu->addSeparator();
+
+    QAction *markInAction = editMenu->addAction("Mark &In");
+    markInAction->setShortcut(QKeySequence("I"));
+    connect(markInAction, &QAction::triggered, this, &SimpleVideoEditor::markIn);
+
+    QAction *markOutAction = editMenu->addAction("Mark &Out");
+    markOutAction->setShortcut(QKeySequence("O"));
+    connect(markOutAction, &QAction::triggered, this, &SimpleVideoEditor::markOut);
+
+    QAction *clearRangesAction = editMenu->addAction("C&lear Ranges");
+    connect(clearRangesAction, &QAction::triggered, [this]()
+            { rangesWidget->clearRanges(); });
+
+    QAction *exportRangesAction = editMenu->addAction("&Export Kept Ranges...");
+    connect(exportRangesAction, &QAction::triggered, this, &SimpleVideoEditor::exportKeptRanges);
+
+    QMenu *viewMenu = menuBar()->addMenu("&View");
+
+    QAction *logAction = viewMenu->addAction("FFMPEG &Log");
+    connect(logAction, &QAction::triggered, this, &SimpleVideoEditor::showLog);
+
+    QAction *metricsAction = viewMenu->addAction("Playback &Metrics");
+    connect(metricsAction, &QAction::triggered, this, &SimpleVideoEditor::showPlaybackMetrics);
+
+    QAction *packetAction = viewMenu->addAction("&Packet Analyzer");
+    connect(packetAction, &QAction::triggered, this, &SimpleVideoEditor::showPacketAnalyzer);
+
     QMenu *helpMenu = menuBar()->addMenu("&Help");
 
     QAction *aboutAction = helpMenu->addAction("&About");
@@ -7,6 +7,22 @@
 #include <QSlider>
 #include <QPushButton>
 #include <QString>
+#include <QStringList>
+
+class FFmpegLog;
+class LogViewerDialog;
+class AudioPeaks;
+class WaveformWidget;
+class KeepRangesWidget;
+class MultiCutExporter;
+class InputPrefetcher;
+class PlaybackMetrics;
+class PlaybackMetricsDialog;
+class PacketAnalyzerDialog;
+class ExportPreview;
+class ImageSequenceExporter;
+class QAction;
+class QDialog;
 
 class SimpleVideoEditor : public QMainWindow
 {
@@ -22,16 +38,49 @@ private slots:
     void cropVideo();
     void resizeVideo();
     void convertVideo();
+    void convertOnWorkers();
+    void changeSpeed();
+    void rotateVideo();
+    void editAudio();
+    void joinVideos();
+    void exportImageSequence();
     void executeFFMPEG(const QStringList &arguments);
+    void showLog();
+    void showPlaybackMetrics();
+    void showPacketAnalyzer();
+    void markIn();
+    void markOut();
+    void exportKeptRanges();
 
 private:
     void createMenus();
+    void loadVideo(const QString &fileName);
+    void convertResumable(const QStringList &arguments, const QString &outputFile, double durationSeconds);
+    void convertSceneAdaptive(const QStringList &arguments, const QString &outputFile, double durationSeconds,
+                              double targetSsim);
+    void conversionSucceeded(const QString &outputFile, const QStringList &arguments);
+    void verifyExport(const QStringList &arguments);
+    int execWithPreview(QDialog &dialog);
 
     QMediaPlayer *mediaPlayer;
     QVideoWidget *videoWidget;
     QSlider *timelineSlider;
     QPushButton *playButton;
+    AudioPeaks *audioPeaks;
+    WaveformWidget *waveformWidget;
+    KeepRangesWidget *rangesWidget;
     QString currentVideoFile;
+    bool awaitingDuration; // Set by loadVideo; previews change the player's duration too
+    FFmpegLog *ffmpegLog;
+    LogViewerDialog *logViewer;
+    MultiCutExporter *multiCutExporter;
+    InputPrefetcher *prefetcher;
+    PlaybackMetrics *playbackMetrics;
+    PlaybackMetricsDialog *playbackMetricsDialog;
+    PacketAnalyzerDialog *packetAnalyzerDialog;
+    ExportPreview *exportPreview;
+    ImageSequenceExporter *imageSequenceExporter;
+    QAction *verifyQualityAction;
 };
 
 #endif // SIMPLEVIDEOEDITOR_H
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "SpeedDialog.h"
+#include <QFormLayout>
+#include <QDialogButtonBox>
+
+namespace
+{
+    // From here on a keyframe-only decode usually still leaves enough frames for smooth output
+    const double keyframeFactor = 8.0;
+}
+
+SpeedDialog::SpeedDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent)
+    : QDialog(parent), videoFile(videoFile), info(info), keyframesTouched(false)
+{
+    setWindowTitle("Change Speed");
+
+    QFormLayout *layout = new QFormLayout(this);
+
+    factorInput = new QDoubleSpinBox(this);
+    factorInput->setDecimals(2);
+    factorInput->setRange(1.1, 200.0);
+    factorInput->setValue(10.0);
+    factorInput->setSuffix("x");
+    layout->addRow("Speed Factor:", factorInput);
+
+    // Keep the source rate, within reason, so the result plays back as smoothly as the original
+    double sourceRate = MediaProbe::frameRateValue(info.frameRate);
+    frameRateInput = new QSpinBox(this);
+    frameRateInput->setRange(1, 120);
+    frameRateInput->setValue(sourceRate > 0 ? qMin(qRound(sourceRate), 60) : 30);
+    frameRateInput->setSuffix(" fps");
+    layout->addRow("Output Frame Rate:", frameRateInput);
+
+    keyframesCheckbox = new QCheckBox("Decode keyframes only (much faster)", this);
+    keyframesCheckbox->setToolTip("Frames between keyframes are skipped by the decoder instead of being "
+                                  "decoded and thrown away. Motion gets choppier when keyframes are far apart.");
+    layout->addRow("", keyframesCheckbox);
+
+    audioCombo = new QComboBox(this);
+    audioCombo->addItem("Drop audio");
+    audioCombo->addItem("Time-stretch (keeps pitch)");
+    audioCombo->setEnabled(info.hasAudio);
+    layout->addRow("Audio:", audioCombo);
+
+    summaryLabel = new QLabel(this);
+    layout->addRow(summaryLabel);
+
+    connect(factorInput, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &SpeedDialog::updateSummary);
+    connect(frameRateInput, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &SpeedDialog::updateSummary);
+    connect(keyframesCheckbox, &QCheckBox::clicked, [this]()
+            {
+        keyframesTouched = true;
+        updateSummary(); });
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    updateSummary();
+}
+
+double SpeedDialog::getSpeedFactor() const
+{
+    return factorInput->value();
+}
+
+int SpeedDialog::getOutputFrameRate() const
+{
+    return frameRateInput->value();
+}
+
+bool SpeedDialog::getKeyframesOnly() const
+{
+    return keyframesCheckbox->isChecked();
+}
+
+bool SpeedDialog::getKeepAudio() const
+{
+    return info.hasAudio && audioCombo->currentIndex() == 1;
+}
+
+QStringList SpeedDialog::getFFMPEGArguments(const QString &outputFile) const
+{
+    return buildArguments(videoFile, getSpeedFactor(), getOutputFrameRate(),
+                          getKeyframesOnly(), getKeepAudio(), outputFile);
+}
+
+QStringList SpeedDialog::buildArguments(const QString &videoFile, double factor, int frameRate,
+                                        bool keyframesOnly, bool keepAudio, const QString &outputFile)
+{
+    QStringList args;
+    args << "-y";
+
+    // Decoder option, so it goes before the input it applies to
+    if (keyframesOnly)
+        args << "-skip_frame" << "nokey";
+
+    args << "-i" << videoFile;
+
+    // Squeeze the timestamps, then resample to a constant rate: the fps filter
+    // drops surplus frames and repeats frames across wide keyframe gaps
+    args << "-vf" << QString("setpts=(PTS-STARTPTS)/%1,fps=%2")
+                         .arg(QString::number(factor, 'g', 6))
+                         .arg(frameRate);
+
+    if (keepAudio)
+        args << "-af" << atempoChain(factor);
+    else
+        args << "-an";
+
+    args << outputFile;
+    return args;
+}
+
+QString SpeedDialog::atempoChain(double factor)
+{
+    QStringList stages;
+    while (factor > 2.0)
+    {
+        stages << "atempo=2.0";
+        factor /= 2.0;
+    }
+    stages << "atempo=" + QString::number(factor, 'f', 6);
+    return stages.join(',');
+}
+
+void SpeedDialog::updateSummary()
+{
+    double factor = getSpeedFactor();
+
+    if (!keyframesTouched)
+        keyframesCheckbox->setChecked(factor >= keyframeFactor);
+
+    QString text = QString("Output length: %1 sec").arg(info.duration / factor, 0, 'f', 1);
+    if (keyframesCheckbox->isChecked())
+        text += "\nOnly keyframes are decoded; frames are repeated where keyframes are sparse.";
+    summaryLabel->setText(text);
+}
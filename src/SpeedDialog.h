@@ -0,0 +1,50 @@
+#ifndef SPEEDDIALOG_H
+#define SPEEDDIALOG_H
+
+#include <QDialog>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include "MediaProbe.h"
+
+class SpeedDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    SpeedDialog(const QString &videoFile, const MediaInfo &info, QWidget *parent = nullptr);
+
+    double getSpeedFactor() const;
+    int getOutputFrameRate() const;
+    bool getKeyframesOnly() const;
+    bool getKeepAudio() const;
+    QStringList getFFMPEGArguments(const QString &outputFile) const;
+
+    // Keyframes-only skips every non-key frame at the decoder; without it all
+    // frames are decoded and the fps filter picks the ones to keep
+    static QStringList buildArguments(const QString &videoFile, double factor, int frameRate,
+                                      bool keyframesOnly, bool keepAudio, const QString &outputFile);
+
+    // atempo stages of at most 2x each, so older ffmpeg builds accept any factor
+    static QString atempoChain(double factor);
+
+private slots:
+    void updateSummary();
+
+private:
+    QString videoFile;
+    MediaInfo info;
+
+    QDoubleSpinBox *factorInput;
+    QSpinBox *frameRateInput;
+    QCheckBox *keyframesCheckbox;
+    QComboBox *audioCombo;
+    QLabel *summaryLabel;
+    bool keyframesTouched; // Stop suggesting a mode once the user has picked one
+};
+
+#endif // SPEEDDIALOG_H
@@ -53,14 +53,23 @@ double TrimDialog::getEndTime() const
 }
 
 QStringList TrimDialog::getFFMPEGArguments(const QString &outputFile) const
+{
+    return buildArguments(videoFile, getStartTime(), getEndTime(), outputFile);
+}
+
+QStringList TrimDialog::buildArguments(const QString &videoFile, double startTime, double endTime,
+                                       const QString &outputFile)
 {
     QStringList args;
-    args << "-y"                                     // Overwrite output files without asking
-         << "-i" << videoFile                        // Input file
-         << "-ss" << QString::number(getStartTime()) // Start time
-         << "-to" << QString::number(getEndTime())   // End time
-         << "-c" << "copy"                           // Copy codec (fast, no re-encode)
-         << outputFile;                              // Output file
+    args << "-y"                                // Overwrite output files without asking
+         << "-i" << videoFile                   // Input file
+         << "-ss" << QString::number(startTime); // Start time
+
+    if (endTime > 0)
+        args << "-to" << QString::number(endTime); // End time
+
+    args << "-c" << "copy" // Copy codec (fast, no re-encode)
+         << outputFile;    // Output file
 
     return args;
 }
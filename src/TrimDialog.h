@@ -17,6 +17,10 @@ public:
     double getEndTime() const;
     QStringList getFFMPEGArguments(const QString &outputFile) const;
 
+    // An end time of zero or less keeps everything after the start
+    static QStringList buildArguments(const QString &videoFile, double startTime, double endTime,
+                                      const QString &outputFile);
+
 private slots:
     void validateTimes();
 
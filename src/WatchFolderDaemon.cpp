@@ -0,0 +1,520 @@
+#include "WatchFolderDaemon.h"
+#include "TrimDialog.h"
+#include "ResizeDialog.h"
+#include "ConvertDialog.h"
+#include "FFmpegLog.h"
+#include "MediaProbe.h"
+#include "QualityVerifier.h"
+#include <QProcess>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char *stateFileName = ".save-queue.json";
+    const char *workDirName = ".save-work";
+
+    // A closed file must stay untouched this long; without a close event we wait longer
+    const int closedSettleMs = 1000;
+    const int unclosedSettleMs = 5000;
+}
+
+WatchFolderDaemon::WatchFolderDaemon(const QString &inboxDir, const QString &outboxDir,
+                                     const QJsonObject &preset, int maxJobs, QObject *parent)
+    : QObject(parent), inboxDir(QDir(inboxDir).absolutePath()), outboxDir(QDir(outboxDir).absolutePath()),
+      preset(preset), maxJobs(qMax(1, maxJobs)), watcher(nullptr), inotifyNotifier(nullptr),
+      inotifyFd(-1), log(new FFmpegLog(500, this))
+{
+}
+
+WatchFolderDaemon::~WatchFolderDaemon()
+{
+#ifdef Q_OS_LINUX
+    if (inotifyFd >= 0)
+        ::close(inotifyFd);
+#endif
+}
+
+bool WatchFolderDaemon::validatePreset(const QJsonObject &preset, QString *error)
+{
+    if (!preset.contains("trim") && !preset.contains("resize") && !preset.contains("convert"))
+    {
+        *error = "Preset needs at least one of \"trim\", \"resize\" or \"convert\"";
+        return false;
+    }
+
+    QJsonObject resize = preset["resize"].toObject();
+    if (preset.contains("resize") && (resize["width"].toInt() <= 0 || resize["height"].toInt() <= 0))
+    {
+        *error = "Preset \"resize\" needs a positive width and height";
+        return false;
+    }
+
+    return true;
+}
+
+bool WatchFolderDaemon::start(QString *error)
+{
+    if (!QFileInfo(inboxDir).isDir())
+    {
+        *error = "Inbox is not a directory: " + inboxDir;
+        return false;
+    }
+    if (!QDir().mkpath(outboxDir))
+    {
+        *error = "Cannot create outbox: " + outboxDir;
+        return false;
+    }
+
+    loadState();
+
+    // Nothing can still be running after a restart; half-done work is redone from scratch
+    QDir(outboxDir + "/" + workDirName).removeRecursively();
+
+#ifdef Q_OS_LINUX
+    // inotify tells us when a writer closes the file, which is the real "finished" signal
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0 &&
+        inotify_add_watch(inotifyFd, QFile::encodeName(inboxDir).constData(),
+                          IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO) >= 0)
+    {
+        inotifyNotifier = new QSocketNotifier(inotifyFd, QSocketNotifier::Read, this);
+        connect(inotifyNotifier, &QSocketNotifier::activated, this, &WatchFolderDaemon::readInotifyEvents);
+    }
+#endif
+
+    if (!inotifyNotifier)
+    {
+        // Portable fallback: directory change notifications plus size/mtime settling
+        watcher = new QFileSystemWatcher(QStringList() << inboxDir, this);
+        connect(watcher, &QFileSystemWatcher::directoryChanged, this, &WatchFolderDaemon::scanInbox);
+    }
+
+    candidateTimer.setInterval(500);
+    connect(&candidateTimer, &QTimer::timeout, this, &WatchFolderDaemon::checkCandidates);
+    candidateTimer.start();
+
+    qInfo().noquote() << "Watching" << inboxDir << "->" << outboxDir << "with" << maxJobs << "worker(s)";
+
+    // Pick up whatever arrived while we were not running, then resume the queue
+    scanInbox();
+    startJobs();
+    return true;
+}
+
+void WatchFolderDaemon::scanInbox()
+{
+    const QStringList files = QDir(inboxDir).entryList(QDir::Files | QDir::NoDotAndDotDot);
+    for (const QString &fileName : files)
+        considerFile(fileName, false);
+}
+
+void WatchFolderDaemon::readInotifyEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buffer[4096];
+
+    for (;;)
+    {
+        ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (char *ptr = buffer; ptr < buffer + length;)
+        {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0 || (event->mask & IN_ISDIR))
+                continue;
+
+            QString fileName = QFile::decodeName(event->name);
+            considerFile(fileName, event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO));
+        }
+    }
+#endif
+}
+
+void WatchFolderDaemon::considerFile(const QString &fileName, bool writerClosed)
+{
+    // Hidden files are usually partial downloads or editor temp files
+    if (fileName.startsWith('.'))
+        return;
+
+    QFileInfo info(inboxDir + "/" + fileName);
+    if (!info.isFile())
+        return;
+
+    qint64 size = info.size();
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if (jobs.contains(jobKey(fileName, size, modified)))
+        return;
+
+    auto it = candidates.find(fileName);
+    if (it == candidates.end())
+    {
+        Candidate candidate;
+        candidate.size = size;
+        candidate.modified = modified;
+        candidate.unchangedFor.start();
+        candidate.writerClosed = writerClosed;
+        candidates.insert(fileName, candidate);
+        return;
+    }
+
+    if (it->size != size || it->modified != modified)
+    {
+        it->size = size;
+        it->modified = modified;
+        it->unchangedFor.restart();
+        it->writerClosed = false;
+    }
+    it->writerClosed = it->writerClosed || writerClosed;
+}
+
+void WatchFolderDaemon::checkCandidates()
+{
+    for (auto it = candidates.begin(); it != candidates.end();)
+    {
+        QFileInfo info(inboxDir + "/" + it.key());
+        if (!info.isFile())
+        {
+            it = candidates.erase(it);
+            continue;
+        }
+
+        // Any change means someone is still writing
+        qint64 size = info.size();
+        qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        if (size != it->size || modified != it->modified)
+        {
+            it->size = size;
+            it->modified = modified;
+            it->unchangedFor.restart();
+            it->writerClosed = false;
+            ++it;
+            continue;
+        }
+
+        int settleMs = it->writerClosed ? closedSettleMs : unclosedSettleMs;
+        if (it->unchangedFor.elapsed() < settleMs)
+        {
+            ++it;
+            continue;
+        }
+
+        enqueue(it.key(), size, modified);
+        it = candidates.erase(it);
+    }
+
+    startJobs();
+}
+
+QString WatchFolderDaemon::jobKey(const QString &fileName, qint64 size, qint64 modified)
+{
+    // A file replaced under the same name is a new job
+    return QString("%1|%2|%3").arg(fileName).arg(size).arg(modified);
+}
+
+void WatchFolderDaemon::enqueue(const QString &fileName, qint64 size, qint64 modified)
+{
+    Job job;
+    job.fileName = fileName;
+    job.size = size;
+    job.modified = modified;
+    job.state = "queued";
+
+    QString key = jobKey(fileName, size, modified);
+    jobs.insert(key, job);
+    queueOrder.append(key);
+    saveState();
+
+    qInfo().noquote() << "Queued" << fileName;
+}
+
+void WatchFolderDaemon::startJobs()
+{
+    for (const QString &key : queueOrder)
+    {
+        if (running.size() >= maxJobs)
+            break;
+        if (jobs[key].state == "queued")
+            startJob(key);
+    }
+}
+
+void WatchFolderDaemon::startJob(const QString &key)
+{
+    Job &job = jobs[key];
+    job.state = "running";
+    job.quality = QJsonObject();
+    saveState();
+
+    QFileInfo sourceInfo(inboxDir + "/" + job.fileName);
+    QString baseName = sourceInfo.completeBaseName();
+
+    // All intermediate and final files live in a per-job directory inside the outbox,
+    // so the finished result can be moved into place atomically
+    QString hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    RunningJob run;
+    run.workDir = outboxDir + "/" + workDirName + "/" + hash;
+    run.step = 0;
+    run.process = nullptr;
+    run.sourceFile = sourceInfo.absoluteFilePath();
+    run.sourceStart = preset.contains("trim") ? preset["trim"].toObject()["start"].toDouble() : 0;
+    QDir().mkpath(run.workDir + "/out");
+
+    bool hasConvert = preset.contains("convert");
+    ConvertDialog::Settings convertSettings = ConvertDialog::Settings::fromJson(preset["convert"].toObject());
+    bool streaming = hasConvert && ConvertDialog::isStreamingFormat(convertSettings.format);
+    QString finalExtension = hasConvert ? ConvertDialog::extensionForFormat(convertSettings.format)
+                                        : sourceInfo.suffix();
+
+    int stepCount = int(preset.contains("trim")) + int(preset.contains("resize")) + int(hasConvert);
+    QString input = sourceInfo.absoluteFilePath();
+    auto stepOutput = [&](int index)
+    {
+        // Matroska holds whatever the intermediate steps produce
+        return index == stepCount - 1 ? run.workDir + "/out/" + baseName + "." + finalExtension
+                                      : run.workDir + QString("/step%1.mkv").arg(index);
+    };
+
+    // The same builders the dialogs use, so results match the GUI exactly
+    if (preset.contains("trim"))
+    {
+        QJsonObject trim = preset["trim"].toObject();
+        QString output = stepOutput(run.steps.size());
+        run.steps << TrimDialog::buildArguments(input, trim["start"].toDouble(), trim["end"].toDouble(), output);
+        input = output;
+    }
+    if (preset.contains("resize"))
+    {
+        QJsonObject resize = preset["resize"].toObject();
+        QString output = stepOutput(run.steps.size());
+        run.steps << ResizeDialog::buildArguments(input, resize["width"].toInt(), resize["height"].toInt(),
+                                                  resize["algorithm"].toString("bicubic"), output);
+        input = output;
+    }
+    if (hasConvert)
+    {
+        QString output = stepOutput(run.steps.size());
+        run.steps << ConvertDialog::buildArguments(input, convertSettings, output);
+        input = output;
+    }
+
+    // The source gets every step's crop and scale before it is compared with the result
+    run.verify = preset["verify"].toBool() && QualityVerifier::canVerify(run.steps.last());
+    QStringList geometry;
+    for (const QStringList &step : run.steps)
+    {
+        QString filter = QualityVerifier::referenceFilter(step);
+        if (!filter.isEmpty())
+            geometry << filter;
+    }
+    run.referenceFilter = geometry.join(',');
+
+    // Segmented outputs are a whole directory of playlists and segments
+    run.result = streaming ? run.workDir + "/out" : input;
+    run.destination = streaming ? outboxDir + "/" + baseName : outboxDir + "/" + QFileInfo(input).fileName();
+
+    running.insert(key, run);
+    qInfo().noquote() << "Started" << job.fileName;
+    runStep(key);
+}
+
+void WatchFolderDaemon::runStep(const QString &key)
+{
+    RunningJob &run = running[key];
+
+    QProcess *process = new QProcess(this);
+    run.process = process;
+    log->attach(process, jobs[key].fileName);
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, key, process](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                QString error = log->lastError(process);
+                process->deleteLater();
+
+                if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+                {
+                    finishJob(key, error.isEmpty() ? "ffmpeg failed" : error);
+                    return;
+                }
+
+                RunningJob &run = running[key];
+                if (++run.step < run.steps.size())
+                {
+                    runStep(key);
+                    return;
+                }
+                if (run.verify)
+                {
+                    verifyJob(key);
+                    return;
+                }
+                finishJob(key, QString());
+            });
+
+    // finished is never emitted when ffmpeg can't be started at all. The job is finished from
+    // the event loop, since that starts the next job while the process is still signalling
+    connect(process, &QProcess::errorOccurred, this, [this, key, process](QProcess::ProcessError error)
+            {
+                if (error != QProcess::FailedToStart)
+                    return;
+                process->deleteLater();
+                QString message = "Could not start ffmpeg: " + process->errorString();
+                QMetaObject::invokeMethod(this, [this, key, message]()
+                                          { finishJob(key, message); }, Qt::QueuedConnection);
+            });
+
+    process->start("ffmpeg", FFmpegLog::loggingArguments() << "-nostdin" << run.steps[run.step]);
+}
+
+void WatchFolderDaemon::verifyJob(const QString &key)
+{
+    const RunningJob &run = running[key];
+    MediaInfo info = MediaProbe::probe(run.result);
+    if (info.duration <= 0)
+    {
+        finishJob(key, QString());
+        return;
+    }
+
+    // A failed check is recorded but does not fail the export
+    QualityVerifier *verifier = new QualityVerifier(log, this);
+    connect(verifier, &QualityVerifier::finished, this,
+            [this, key, verifier](bool success, const QString &error)
+            {
+                Job &job = jobs[key];
+                if (success)
+                {
+                    job.quality = verifier->report().toJson();
+                    qInfo().noquote() << "Quality of" << job.fileName << ":" << verifier->report().summary();
+                }
+                else
+                {
+                    job.quality = QJsonObject();
+                    job.quality["error"] = error;
+                    qWarning().noquote() << "Quality check of" << job.fileName << "failed:" << error;
+                }
+                verifier->deleteLater();
+                finishJob(key, QString());
+            });
+
+    verifier->start(run.sourceFile, run.sourceStart, run.result, info.duration, run.referenceFilter);
+}
+
+void WatchFolderDaemon::finishJob(const QString &key, const QString &error)
+{
+    RunningJob run = running.take(key);
+    Job &job = jobs[key];
+
+    if (error.isEmpty())
+    {
+        // Replace rather than rename around an existing result: if we crashed after the
+        // move but before saving state, redoing the job must not leave a duplicate
+        if (QFileInfo(run.destination).isDir())
+            QDir(run.destination).removeRecursively();
+        else
+            QFile::remove(run.destination);
+
+        if (QFile::rename(run.result, run.destination))
+        {
+            job.state = "done";
+            job.output = run.destination;
+            qInfo().noquote() << "Finished" << job.fileName << "->" << run.destination;
+        }
+        else
+        {
+            job.state = "failed";
+            job.error = "Could not move result to " + run.destination;
+        }
+    }
+    else
+    {
+        job.state = "failed";
+        job.error = error;
+    }
+
+    if (job.state == "failed")
+        qWarning().noquote() << "Failed" << job.fileName << ":" << job.error;
+
+    QDir(run.workDir).removeRecursively();
+    saveState();
+    startJobs();
+}
+
+void WatchFolderDaemon::loadState()
+{
+    QFile file(outboxDir + "/" + stateFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonArray entries = QJsonDocument::fromJson(file.readAll()).object()["jobs"].toArray();
+    for (const QJsonValue &value : entries)
+    {
+        QJsonObject entry = value.toObject();
+        Job job;
+        job.fileName = entry["file"].toString();
+        job.size = entry["size"].toVariant().toLongLong();
+        job.modified = entry["modified"].toVariant().toLongLong();
+        job.state = entry["state"].toString();
+        job.output = entry["output"].toString();
+        job.error = entry["error"].toString();
+        job.quality = entry["quality"].toObject();
+
+        // Interrupted jobs go back in the queue
+        if (job.state == "running")
+            job.state = "queued";
+
+        QString key = jobKey(job.fileName, job.size, job.modified);
+        jobs.insert(key, job);
+        queueOrder.append(key);
+    }
+}
+
+void WatchFolderDaemon::saveState() const
+{
+    QJsonArray entries;
+    for (const QString &key : queueOrder)
+    {
+        const Job &job = jobs[key];
+        QJsonObject entry;
+        entry["file"] = job.fileName;
+        entry["size"] = job.size;
+        entry["modified"] = job.modified;
+        entry["state"] = job.state;
+        if (!job.output.isEmpty())
+            entry["output"] = job.output;
+        if (!job.error.isEmpty())
+            entry["error"] = job.error;
+        if (!job.quality.isEmpty())
+            entry["quality"] = job.quality;
+        entries.append(entry);
+    }
+
+    QJsonObject root;
+    root["jobs"] = entries;
+
+    // Written to a temporary file and renamed, so a crash never leaves half a state file
+    QSaveFile file(outboxDir + "/" + stateFileName);
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(QJsonDocument(root).toJson());
+        file.commit();
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef WATCHFOLDERDAEMON_H
+#define WATCHFOLDERDAEMON_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QProcess;
+class QFileSystemWatcher;
+class QSocketNotifier;
+class FFmpegLog;
+
+// Headless watch-folder mode: every file that lands in the inbox is run through
+// the preset's trim/resize/convert steps (using the dialogs' own argument
+// builders) and the result is moved to the outbox. Queue state is persisted in
+// the outbox so a restart neither loses nor repeats work.
+class WatchFolderDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    WatchFolderDaemon(const QString &inboxDir, const QString &outboxDir,
+                      const QJsonObject &preset, int maxJobs, QObject *parent = nullptr);
+    ~WatchFolderDaemon();
+
+    bool start(QString *error);
+
+    // Checks a preset before the daemon starts
+    static bool validatePreset(const QJsonObject &preset, QString *error);
+
+private slots:
+    void scanInbox();
+    void checkCandidates();
+    void readInotifyEvents();
+
+private:
+    struct Job
+    {
+        QString fileName; // Relative to the inbox
+        qint64 size;
+        qint64 modified;
+        QString state; // "queued", "running", "done" or "failed"
+        QString output;
+        QString error;
+        QJsonObject quality; // From the preset's "verify" step
+    };
+
+    // A file that has appeared but may still be being written
+    struct Candidate
+    {
+        qint64 size;
+        qint64 modified;
+        QElapsedTimer unchangedFor;
+        bool writerClosed;
+    };
+
+    struct RunningJob
+    {
+        QList<QStringList> steps;
+        int step;
+        QString workDir;
+        QString result;      // File (or directory, for HLS/DASH) the last step produces
+        QString destination; // Where the result goes in the outbox
+        QProcess *process;
+
+        // Quality check of the result against the source, when the preset asks for it
+        bool verify;
+        QString sourceFile;
+        double sourceStart;
+        QString referenceFilter;
+    };
+
+    static QString jobKey(const QString &fileName, qint64 size, qint64 modified);
+
+    void considerFile(const QString &fileName, bool writerClosed);
+    void enqueue(const QString &fileName, qint64 size, qint64 modified);
+    void startJobs();
+    void startJob(const QString &key);
+    void runStep(const QString &key);
+    void verifyJob(const QString &key);
+    void finishJob(const QString &key, const QString &error);
+
+    void loadState();
+    void saveState() const;
+
+    QString inboxDir;
+    QString outboxDir;
+    QJsonObject preset;
+    int maxJobs;
+
+    QHash<QString, Job> jobs;
+    QStringList queueOrder; // Job keys, oldest first
+    QHash<QString, Candidate> candidates;
+    QHash<QString, RunningJob> running;
+
+    QTimer candidateTimer;
+    QFileSystemWatcher *watcher;
+    QSocketNotifier *inotifyNotifier;
+    int inotifyFd;
+    FFmpegLog *log;
+};
+
+#endif // WATCHFOLDERDAEMON_H
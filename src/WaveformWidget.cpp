@@ -0,0 +1,161 @@
+#include "WaveformWidget.h"
+#include "AudioPeaks.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QVector>
+
+WaveformWidget::WaveformWidget(AudioPeaks *peaks, QWidget *parent)
+    : QWidget(parent), peaks(peaks), duration(0), position(0),
+      viewStart(0), viewEnd(0), cacheValid(false)
+{
+    setMinimumHeight(60);
+    setMaximumHeight(80);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
+    connect(peaks, &AudioPeaks::ready, this, &WaveformWidget::peaksChanged);
+    connect(peaks, &AudioPeaks::failed, this, &WaveformWidget::peaksChanged);
+}
+
+void WaveformWidget::setDuration(qint64 newDuration)
+{
+    duration = newDuration;
+    viewStart = 0;
+    viewEnd = duration;
+    invalidate();
+}
+
+void WaveformWidget::setPosition(qint64 newPosition)
+{
+    if (newPosition == position)
+        return;
+
+    // Only the two playhead columns need repainting
+    int oldX = xFor(position);
+    position = newPosition;
+    int newX = xFor(position);
+    update(QRect(oldX - 1, 0, 3, height()));
+    update(QRect(newX - 1, 0, 3, height()));
+}
+
+void WaveformWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+
+    if (!cacheValid)
+    {
+        waveformCache = QPixmap(size() * devicePixelRatioF());
+        waveformCache.setDevicePixelRatio(devicePixelRatioF());
+        waveformCache.fill(QColor(30, 30, 30));
+
+        QPainter cachePainter(&waveformCache);
+        int mid = height() / 2;
+
+        if (peaks->isReady() && viewEnd > viewStart)
+        {
+            QVector<qint16> mins;
+            QVector<qint16> maxs;
+            peaks->peaksForRange(viewStart, viewEnd, width(), mins, maxs);
+
+            cachePainter.setPen(QColor(90, 170, 255));
+            double scale = (height() / 2.0 - 1) / 32768.0;
+            for (int x = 0; x < width(); ++x)
+            {
+                cachePainter.drawLine(x, mid - qRound(maxs[x] * scale),
+                                      x, mid - qRound(mins[x] * scale));
+            }
+        }
+        else
+        {
+            cachePainter.setPen(Qt::gray);
+            QString text = peaks->hasFailed() ? "No audio" : "Building waveform...";
+            cachePainter.drawText(rect(), Qt::AlignCenter, duration > 0 ? text : QString());
+        }
+
+        cachePainter.setPen(QColor(70, 70, 70));
+        cachePainter.drawLine(0, mid, width(), mid);
+        cacheValid = true;
+    }
+
+    // Blit only the damaged area; seeks and playback just move the playhead
+    painter.drawPixmap(event->rect(), waveformCache, QRectF(event->rect().topLeft() * devicePixelRatioF(),
+                                                            event->rect().size() * devicePixelRatioF()));
+
+    if (position >= viewStart && position <= viewEnd && viewEnd > viewStart)
+    {
+        painter.setPen(Qt::red);
+        int x = xFor(position);
+        painter.drawLine(x, 0, x, height());
+    }
+}
+
+void WaveformWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    invalidate();
+}
+
+void WaveformWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && viewEnd > viewStart)
+        emit seekRequested(positionAt(event->position().toPoint().x()));
+}
+
+void WaveformWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if ((event->buttons() & Qt::LeftButton) && viewEnd > viewStart)
+        emit seekRequested(positionAt(event->position().toPoint().x()));
+}
+
+void WaveformWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    // Back to the whole file
+    viewStart = 0;
+    viewEnd = duration;
+    invalidate();
+}
+
+void WaveformWidget::wheelEvent(QWheelEvent *event)
+{
+    if (viewEnd <= viewStart || duration < 100)
+        return;
+
+    // Zoom around the cursor; peaks come from whichever pyramid level fits
+    qint64 anchor = positionAt(event->position().toPoint().x());
+    double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+    // Narrowest view is a millisecond per pixel, but never more than the whole clip
+    qint64 narrowest = qMin<qint64>(qMax<qint64>(width(), 100), duration);
+    qint64 span = qBound<qint64>(narrowest, qint64((viewEnd - viewStart) * factor), duration);
+
+    double anchorRatio = double(anchor - viewStart) / (viewEnd - viewStart);
+    viewStart = qBound<qint64>(0, anchor - qint64(span * anchorRatio), duration - span);
+    viewEnd = viewStart + span;
+
+    invalidate();
+    event->accept();
+}
+
+void WaveformWidget::peaksChanged()
+{
+    invalidate();
+}
+
+qint64 WaveformWidget::positionAt(int x) const
+{
+    if (width() <= 0)
+        return viewStart;
+    return viewStart + qint64(double(qBound(0, x, width())) / width() * (viewEnd - viewStart));
+}
+
+int WaveformWidget::xFor(qint64 timestamp) const
+{
+    if (viewEnd <= viewStart)
+        return 0;
+    return int(double(timestamp - viewStart) / (viewEnd - viewStart) * width());
+}
+
+void WaveformWidget::invalidate()
+{
+    cacheValid = false;
+    update();
+}
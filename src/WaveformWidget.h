@@ -0,0 +1,50 @@
+#ifndef WAVEFORMWIDGET_H
+#define WAVEFORMWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+
+class AudioPeaks;
+
+// Audio waveform strip drawn from precomputed peaks. Scroll to zoom around the
+// cursor, double-click to show the whole file, click or drag to seek.
+class WaveformWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    WaveformWidget(AudioPeaks *peaks, QWidget *parent = nullptr);
+
+    void setDuration(qint64 duration);
+    void setPosition(qint64 position);
+
+signals:
+    void seekRequested(qint64 position);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private slots:
+    void peaksChanged();
+
+private:
+    qint64 positionAt(int x) const;
+    int xFor(qint64 position) const;
+    void invalidate();
+
+    AudioPeaks *peaks;
+    qint64 duration;
+    qint64 position;
+    qint64 viewStart; // Visible range in milliseconds
+    qint64 viewEnd;
+
+    QPixmap waveformCache; // Rendered waveform; the playhead is drawn on top
+    bool cacheValid;
+};
+
+#endif // WAVEFORMWIDGET_H
@@ -1,9 +1,17 @@
 #include "SimpleVideoEditor.h"
 #include "ConvertDialog.h"
+#include "FFmpegLog.h"
+#include "ResumableExport.h"
+#include "ExportPreview.h"
+#include "SceneAdaptiveEncoder.h"
+#include "DistributedEncoder.h"
+#include "MessageChannel.h"
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QProcess>
 #include <QStatusBar>
+#include <QFileInfo>
+#include <QInputDialog>
 
 void SimpleVideoEditor::convertVideo()
 {
@@ -13,11 +21,15 @@ void SimpleVideoEditor::convertVideo()
         return;
     }
 
-    ConvertDialog dialog(currentVideoFile, this);
-    if (dialog.exec() == QDialog::Accepted)
+    // Read before a preview can swap the player's source
+    qint64 duration = mediaPlayer->duration();
+    ConvertDialog dialog(currentVideoFile, duration, this);
+    dialog.setExportPreview(exportPreview);
+    int result = execWithPreview(dialog);
+
+    if (result == QDialog::Accepted)
     {
-        QString format = dialog.getOutputFormat();
-        QString extension = "." + format;
+        QString extension = "." + dialog.getOutputExtension();
 
         QString outputFile = QFileDialog::getSaveFileName(this,
                                                           "Save Converted Video", "",
@@ -27,39 +39,197 @@ void SimpleVideoEditor::convertVideo()
         {
             QStringList arguments = dialog.getFFMPEGArguments(outputFile);
 
+            // Scene-adaptive jobs run as separate scene encodes of their own
+            double durationSeconds = duration / 1000.0;
+            if (dialog.getSceneAdaptive() && durationSeconds > 0)
+            {
+                convertSceneAdaptive(arguments, outputFile, durationSeconds, dialog.getTargetSsim());
+                return;
+            }
+
+            // Long jobs run as resumable segments so an interruption costs at most one segment
+            if (ResumableExport::isSupported(dialog.getOutputFormat()) && durationSeconds >= 5 * 60)
+            {
+                convertResumable(arguments, outputFile, durationSeconds);
+                return;
+            }
+
             // Execute FFMPEG with progress feedback
             QProcess *ffmpeg = new QProcess(this);
             statusBar()->showMessage("Converting video...");
+            ffmpegLog->attach(ffmpeg, QFileInfo(outputFile).fileName());
 
             connect(ffmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                    [this, ffmpeg, outputFile](int exitCode, QProcess::ExitStatus exitStatus)
+                    [this, ffmpeg, outputFile, arguments](int exitCode, QProcess::ExitStatus exitStatus)
                     {
                         if (exitCode == 0)
                         {
-                            statusBar()->showMessage("Video converted successfully");
-
-                            // Ask if user wants to load the new video
-                            QMessageBox::StandardButton reply = QMessageBox::question(this,
-                                                                                      "Conversion Complete",
-                                                                                      "Would you like to load the converted video?",
-                                                                                      QMessageBox::Yes | QMessageBox::No);
-
-                            if (reply == QMessageBox::Yes)
-                            {
-                                currentVideoFile = outputFile;
-                                mediaPlayer->setSource(QUrl::fromLocalFile(outputFile));
-                                playButton->setText("Play");
-                            }
+                            conversionSucceeded(outputFile, arguments);
                         }
                         else
                         {
                             QMessageBox::critical(this, "Error",
-                                                  "FFMPEG error: " + QString(ffmpeg->readAllStandardError()));
+                                                  "FFMPEG error: " + ffmpegLog->lastError(ffmpeg) +
+                                                      "\n\nSee View > FFMPEG Log for the full output.");
                         }
                         ffmpeg->deleteLater();
                     });
 
-            ffmpeg->start("ffmpeg", arguments);
+            ffmpeg->start("ffmpeg", FFmpegLog::loggingArguments() + arguments);
+        }
+    }
+}
+
+void SimpleVideoEditor::convertOnWorkers()
+{
+    if (currentVideoFile.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", "No video loaded to convert");
+        return;
+    }
+
+    ConvertDialog dialog(currentVideoFile, mediaPlayer->duration(), this);
+    dialog.setWindowTitle("Convert on Workers");
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    ConvertDialog::Settings settings = dialog.getSettings();
+    if (!DistributedEncoder::isSupported(settings.format))
+    {
+        QMessageBox::warning(this, "Warning",
+                             "Encoding on workers needs a single-file format (MP4, MOV, MKV or WebM).");
+        return;
+    }
+
+    // Workers are started with: SimpleVideoEditor --worker <port> --token <secret>
+    bool ok = false;
+    QString list = QInputDialog::getText(this, "Convert on Workers",
+                                         "Worker addresses (host:port, separated by commas):",
+                                         QLineEdit::Normal,
+                                         QString("localhost:%1").arg(MessageChannel::defaultPort), &ok);
+    if (!ok)
+        return;
+
+    QString error;
+    QStringList workers = DistributedEncoder::parseWorkers(list, &error);
+    if (workers.isEmpty())
+    {
+        QMessageBox::warning(this, "Warning", error);
+        return;
+    }
+
+    QString token = QInputDialog::getText(this, "Convert on Workers",
+                                          "Worker token (as given to --token):",
+                                          QLineEdit::Password, QString(), &ok);
+    if (!ok || token.isEmpty())
+        return;
+
+    QString extension = "." + dialog.getOutputExtension();
+    QString outputFile = QFileDialog::getSaveFileName(this,
+                                                      "Save Converted Video", "",
+                                                      "Video Files (*" + extension + ")");
+    if (outputFile.isEmpty())
+        return;
+
+    // What a local conversion would have run, for the quality check
+    QStringList arguments = ConvertDialog::buildArguments(currentVideoFile, settings, outputFile);
+
+    DistributedEncoder *job = new DistributedEncoder(ffmpegLog, this);
+    connect(job, &DistributedEncoder::progress, [this](const QString &status)
+            { statusBar()->showMessage(status); });
+    connect(job, &DistributedEncoder::finished, [this, job, outputFile, arguments](bool success, const QString &error)
+            {
+        if (success)
+        {
+            conversionSucceeded(outputFile, arguments);
+        }
+        else
+        {
+            QMessageBox::critical(this, "Error",
+                                  "Distributed conversion failed: " + error +
+                                      "\n\nSee View > FFMPEG Log for the local steps.");
+        }
+        job->deleteLater(); });
+
+    job->start(currentVideoFile, settings, outputFile, workers, token.toUtf8());
+}
+
+void SimpleVideoEditor::convertResumable(const QStringList &arguments, const QString &outputFile,
+                                         double durationSeconds)
+{
+    // An interrupted run of this exact job left segments behind
+    double done = ResumableExport::completedSeconds(arguments, outputFile);
+    if (done > 0)
+    {
+        QMessageBox::StandardButton reply = QMessageBox::question(this,
+                                                                  "Resume Conversion",
+                                                                  QString("A previous conversion to this file stopped after %1 of %2 minutes.\n\n"
+                                                                          "Resume it? Choose No to start over.")
+                                                                      .arg(done / 60, 0, 'f', 1)
+                                                                      .arg(durationSeconds / 60, 0, 'f', 1),
+                                                                  QMessageBox::Yes | QMessageBox::No);
+        if (reply == QMessageBox::No)
+            ResumableExport::discard(outputFile);
+    }
+
+    ResumableExport *job = new ResumableExport(ffmpegLog, this);
+    connect(job, &ResumableExport::progress, [this](double completed, double total)
+            { statusBar()->showMessage(QString("Converting video... %1%").arg(total > 0 ? qRound(100 * completed / total) : 0)); });
+    connect(job, &ResumableExport::finished, [this, job, outputFile, arguments](bool success, const QString &error)
+            {
+        if (success)
+        {
+            conversionSucceeded(outputFile, arguments);
+        }
+        else
+        {
+            QMessageBox::critical(this, "Error",
+                                  "FFMPEG error: " + error +
+                                      "\n\nFinished segments were kept; converting to the same file again resumes the job.");
+        }
+        job->deleteLater(); });
+
+    statusBar()->showMessage("Converting video...");
+    job->start(arguments, outputFile, durationSeconds);
+}
+
+void SimpleVideoEditor::convertSceneAdaptive(const QStringList &arguments, const QString &outputFile,
+                                             double durationSeconds, double targetSsim)
+{
+    SceneAdaptiveEncoder *job = new SceneAdaptiveEncoder(ffmpegLog, this);
+    connect(job, &SceneAdaptiveEncoder::progress, [this](const QString &status)
+            { statusBar()->showMessage(status); });
+    connect(job, &SceneAdaptiveEncoder::finished, [this, job, outputFile, arguments](bool success, const QString &error)
+            {
+        if (success)
+        {
+            conversionSucceeded(outputFile, arguments);
+            statusBar()->showMessage("Video converted successfully: " + job->summary());
+        }
+        else
+        {
+            QMessageBox::critical(this, "Error",
+                                  "FFMPEG error: " + error +
+                                      "\n\nSee View > FFMPEG Log for the full output.");
         }
+        job->deleteLater(); });
+
+    job->start(arguments, outputFile, durationSeconds, targetSsim);
+}
+
+void SimpleVideoEditor::conversionSucceeded(const QString &outputFile, const QStringList &arguments)
+{
+    statusBar()->showMessage("Video converted successfully");
+    verifyExport(arguments);
+
+    // Ask if user wants to load the new video
+    QMessageBox::StandardButton reply = QMessageBox::question(this,
+                                                              "Conversion Complete",
+                                                              "Would you like to load the converted video?",
+                                                              QMessageBox::Yes | QMessageBox::No);
+
+    if (reply == QMessageBox::Yes)
+    {
+        loadVideo(outputFile);
     }
 }
\ No newline at end of file
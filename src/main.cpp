@@ -1,10 +1,131 @@
 #include <QApplication>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <QHostAddress>
 #include "SimpleVideoEditor.h"
+#include "FFmpegCapabilities.h"
+#include "WatchFolderDaemon.h"
+#include "EncodeWorker.h"
+#include "MessageChannel.h"
+
+// Headless watch-folder mode: SimpleVideoEditor --watch <inbox> --outbox <dir> --preset <file>
+static int runWatchDaemon(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simple Video Editor watch-folder mode");
+    parser.addHelpOption();
+
+    QCommandLineOption watchOption("watch", "Inbox directory to watch for new files.", "inbox");
+    QCommandLineOption outboxOption("outbox", "Directory that receives finished files.", "outbox");
+    QCommandLineOption presetOption("preset", "Preset JSON with \"trim\", \"resize\" and/or \"convert\" sections.", "preset");
+    QCommandLineOption jobsOption("jobs", "Maximum number of files processed at once.", "jobs", "2");
+    parser.addOptions({watchOption, outboxOption, presetOption, jobsOption});
+    parser.process(app);
+
+    if (!parser.isSet(outboxOption) || !parser.isSet(presetOption))
+    {
+        qCritical() << "--watch needs --outbox and --preset";
+        return 1;
+    }
+
+    QFile presetFile(parser.value(presetOption));
+    if (!presetFile.open(QIODevice::ReadOnly))
+    {
+        qCritical().noquote() << "Cannot read preset:" << presetFile.errorString();
+        return 1;
+    }
+
+    QJsonObject preset = QJsonDocument::fromJson(presetFile.readAll()).object();
+    QString error;
+    if (!WatchFolderDaemon::validatePreset(preset, &error))
+    {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    FFmpegCapabilities::instance().probe();
+
+    WatchFolderDaemon daemon(parser.value(watchOption), parser.value(outboxOption),
+                             preset, parser.value(jobsOption).toInt());
+    if (!daemon.start(&error))
+    {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    return app.exec();
+}
+
+// Headless encode worker: SimpleVideoEditor --worker <port> [--listen <address>] [--jobs <n>]
+static int runEncodeWorker(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simple Video Editor encode worker");
+    parser.addHelpOption();
+
+    QCommandLineOption workerOption("worker", "Port to accept coordinators on.", "port",
+                                    QString::number(MessageChannel::defaultPort));
+    QCommandLineOption listenOption("listen", "Address to listen on; use 0.0.0.0 to accept other machines.",
+                                    "address", "127.0.0.1");
+    QCommandLineOption jobsOption("jobs", "Segments encoded at once.", "jobs", "1");
+    QCommandLineOption tokenOption("token", "Shared secret coordinators must know; defaults to $SVE_WORKER_TOKEN.",
+                                   "secret", qEnvironmentVariable("SVE_WORKER_TOKEN"));
+    parser.addOptions({workerOption, listenOption, jobsOption, tokenOption});
+    parser.process(app);
+
+    QHostAddress address;
+    if (!address.setAddress(parser.value(listenOption)))
+    {
+        qCritical().noquote() << "Invalid --listen address:" << parser.value(listenOption);
+        return 1;
+    }
+
+    // Anyone who can reach the port could otherwise make this machine run ffmpeg on their data
+    QByteArray token = parser.value(tokenOption).toUtf8();
+    if (token.isEmpty())
+    {
+        qCritical().noquote() << "A shared token is required: pass --token or set SVE_WORKER_TOKEN";
+        return 1;
+    }
+
+    FFmpegCapabilities::instance().probe();
+
+    QString error;
+    EncodeWorker worker(parser.value(jobsOption).toInt(), token);
+    if (!worker.listen(address, quint16(parser.value(workerOption).toUInt()), &error))
+    {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    // The daemon must not need a display, so decide before creating a QApplication
+    for (int i = 1; i < argc; ++i)
+    {
+        if (QByteArray(argv[i]).startsWith("--watch"))
+            return runWatchDaemon(argc, argv);
+        if (QByteArray(argv[i]).startsWith("--worker"))
+            return runEncodeWorker(argc, argv);
+    }
+
     QApplication app(argc, argv);
+
+    // Find out what the installed ffmpeg supports while the window comes up
+    FFmpegCapabilities::instance().probe();
+
     SimpleVideoEditor editor;
     editor.show();
     return app.exec();
-}
\ No newline at end of file
+}